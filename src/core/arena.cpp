@@ -0,0 +1,228 @@
+#include "arena.h"
+#include "bitboard.h"
+#include "counter_rng.h"
+#include "thread_pool.h"
+#include "zobrist.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+
+std::vector<std::array<int, NUM_PLAYERS>> arenaSeatOrders(const ArenaConfig &config)
+{
+    std::vector<std::array<int, NUM_PLAYERS>> orders;
+    std::array<int, NUM_PLAYERS> order = config.lineup;
+
+    if (!config.rotateSeats)
+    {
+        orders.push_back(order);
+        return orders;
+    }
+
+    // next_permutation skips repeats, so a bot in two seats does not double the games
+    std::sort(order.begin(), order.end());
+
+    do
+    {
+        orders.push_back(order);
+
+    } while (std::next_permutation(order.begin(), order.end()));
+
+    return orders;
+}
+
+ArenaGame playArenaGame(const GameState &start, uint64_t seed, uint64_t board,
+                        const std::array<BotConfig, NUM_PLAYERS> &seats)
+{
+    GameState state = start;
+    ArenaGame game;
+
+    while (!state.isGameOver)
+    {
+        BotConfig bot = seats[state.piecesIndex];
+
+        // every game gets its own playouts, repeatable from the board
+        bot.mcts.seed = splitMix64(bot.mcts.seed ^ streamKey(seed, board));
+        playMove(state, chooseMove(state, bot));
+    }
+
+    game.board = board;
+    game.winnerMask = state.winnerMask;
+
+    for (int seat = 0; seat < NUM_PLAYERS; seat++)
+    {
+        game.scores[seat] = state.pieces[seat].score;
+        game.weights[seat] = state.pieces[seat].currentWeight;
+    }
+
+    return game;
+}
+
+// per-bot totals, and the spread of each bot's per-board mean around its overall rate
+static void summarizeBots(ArenaResult &result, int boards, int gamesPerBoard)
+{
+    std::vector<double> sumOfSquares(result.bots.size(), 0.0);
+
+    for (int board = 0; board < boards; board++)
+    {
+        std::vector<double> shares(result.bots.size(), 0.0);
+        std::vector<int> seatGames(result.bots.size(), 0);
+
+        for (int i = board * gamesPerBoard; i < (board + 1) * gamesPerBoard; i++)
+        {
+            const ArenaGame &game = result.results[i];
+            int winners = popCount(game.winnerMask);
+
+            for (int seat = 0; seat < NUM_PLAYERS; seat++)
+            {
+                ArenaBotResult &bot = result.bots[game.seatBots[seat]];
+                double share = (game.winnerMask & (1 << seat)) ? 1.0 / winners : 0.0;
+
+                bot.seatGames++;
+                bot.winShares += share;
+                bot.scoreSum += game.scores[seat];
+                shares[game.seatBots[seat]] += share;
+                seatGames[game.seatBots[seat]]++;
+            }
+        }
+
+        for (size_t b = 0; b < result.bots.size(); b++)
+        {
+            if (seatGames[b] > 0)
+            {
+                double mean = shares[b] / seatGames[b];
+                sumOfSquares[b] += mean * mean;
+            }
+        }
+    }
+
+    for (size_t b = 0; b < result.bots.size(); b++)
+    {
+        ArenaBotResult &bot = result.bots[b];
+
+        if (bot.seatGames == 0)
+            continue;
+
+        bot.winRate = bot.winShares / bot.seatGames;
+
+        if (boards > 1)
+        {
+            double variance = (sumOfSquares[b] / boards - bot.winRate * bot.winRate) * boards / (boards - 1);
+            bot.winRateError = std::sqrt(std::max(variance, 0.0) / boards);
+        }
+    }
+}
+
+ArenaResult runArena(const ArenaConfig &config)
+{
+    ArenaResult result;
+    std::vector<BotConfig> bots = config.bots;
+    std::vector<std::unique_ptr<TranspositionTable>> tables;
+    std::vector<std::array<int, NUM_PLAYERS>> orders = arenaSeatOrders(config);
+    int gamesPerBoard = (int)orders.size();
+    int totalGames = config.boards * gamesPerBoard;
+
+    for (BotConfig &bot : bots)
+    {
+        if (bot.type == BotType::Search && !bot.search.table)
+        {
+            tables.emplace_back(new TranspositionTable(config.tableMegabytes));
+            bot.search.table = tables.back().get();
+        }
+    }
+
+    std::vector<ArenaGame> games(totalGames);
+    std::vector<int> finishedBoards;
+    std::mutex finishMutex;
+    std::atomic<bool> stop(false);
+    std::atomic<int> unbalanced(0);
+    auto startTime = std::chrono::steady_clock::now();
+
+    {
+        ThreadPool pool(config.threads);
+
+        // one task per board, dealt where it is played so a run stopped early by
+        // onBoardFinished never pays for boards it does not reach
+        for (int board = 0; board < config.boards; board++)
+        {
+            pool.submit([&, board]()
+                        {
+                            if (stop.load())
+                                return;
+
+                            GameState start;
+
+                            if (!config.balancedBoards)
+                                initializeSeededGame(start, config.seed, (uint64_t)board);
+                            else if (dealBalancedBoard(start, config.seed, (uint64_t)board, config.balance) == 0)
+                                unbalanced++;
+
+                            for (int i = board * gamesPerBoard; i < (board + 1) * gamesPerBoard; i++)
+                            {
+                                if (stop.load())
+                                    return;
+
+                                const std::array<int, NUM_PLAYERS> &order = orders[i % gamesPerBoard];
+                                std::array<BotConfig, NUM_PLAYERS> seats;
+
+                                for (int seat = 0; seat < NUM_PLAYERS; seat++)
+                                    seats[seat] = bots[order[seat]];
+
+                                ArenaGame &game = games[i];
+                                game = playArenaGame(start, config.seed, (uint64_t)board, seats);
+
+                                for (int seat = 0; seat < NUM_PLAYERS; seat++)
+                                    game.seatBots[seat] = (uint8_t)order[seat];
+                            }
+
+                            std::lock_guard<std::mutex> lock(finishMutex);
+                            finishedBoards.push_back(board);
+
+                            if (config.onBoardFinished && !stop.load())
+                            {
+                                std::vector<ArenaGame> boardGames(games.begin() + board * gamesPerBoard,
+                                                                  games.begin() + (board + 1) * gamesPerBoard);
+
+                                if (!config.onBoardFinished(boardGames))
+                                    stop = true;
+                            }
+                        });
+        }
+
+        pool.wait();
+    }
+
+    result.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    // whole boards only, in board order
+    std::sort(finishedBoards.begin(), finishedBoards.end());
+
+    for (int board : finishedBoards)
+        result.results.insert(result.results.end(), games.begin() + board * gamesPerBoard,
+                              games.begin() + (board + 1) * gamesPerBoard);
+
+    result.boards = (int)finishedBoards.size();
+    result.unbalancedBoards = unbalanced.load();
+    result.games = (int)result.results.size();
+    result.bots.resize(bots.size());
+
+    for (const ArenaGame &game : result.results)
+    {
+        int winners = popCount(game.winnerMask);
+
+        if (winners > 1)
+            result.ties++;
+
+        for (int seat = 0; seat < NUM_PLAYERS; seat++)
+        {
+            if (game.winnerMask & (1 << seat))
+                result.seatWinShares[seat] += 1.0 / winners;
+        }
+    }
+
+    summarizeBots(result, result.boards, gamesPerBoard);
+    return result;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "balanced_board.h"
+#include "bot.h"
+#include "game_state.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// one finished game, indexed by seat
+struct ArenaGame
+{
+    uint64_t board = 0; // game index of the board in the run's seed
+    std::array<uint8_t, NUM_PLAYERS> seatBots = {}; // index into ArenaConfig::bots
+    std::array<int16_t, NUM_PLAYERS> scores = {};
+    std::array<uint8_t, NUM_PLAYERS> weights = {};
+    uint8_t winnerMask = 0;
+};
+
+struct ArenaConfig
+{
+    std::vector<BotConfig> bots;              // the distinct bots taking part
+    std::array<int, NUM_PLAYERS> lineup = {}; // index into bots for each seat
+    int boards = 100;
+    int threads = 1;
+    uint64_t seed = 1;                        // board i is initializeSeededGame(seed, i) unless balanced
+    size_t tableMegabytes = 16;               // per search bot, shared by every thread
+
+    // plays every board once per distinct seat order of the lineup, so every bot
+    // meets the same boards from every seat and board luck cancels out
+    bool rotateSeats = true;
+
+    // deals board i as dealBalancedBoard(seed, i), so no start corner is far ahead
+    bool balancedBoards = false;
+    BalanceConfig balance;
+
+    // optional, called one board at a time as the last of a board's games finishes,
+    // with that board's games. Returning false ends the run early: games not yet
+    // started are skipped and only whole boards are counted.
+    std::function<bool(const std::vector<ArenaGame> &boardGames)> onBoardFinished;
+};
+
+// totals for one bot over every seat it played
+struct ArenaBotResult
+{
+    int64_t seatGames = 0;
+    double winShares = 0.0; // 1 for a win, 1/n for an n-way tie
+    int64_t scoreSum = 0;
+
+    // mean win share per seat game and its standard error, with boards as the samples.
+    // Rotated boards pair every bot with the same luck, which takes it out of the error.
+    double winRate = 0.0;
+    double winRateError = 0.0;
+};
+
+struct ArenaResult
+{
+    int boards = 0; // boards whose games all finished
+    int games = 0;
+    int ties = 0;
+    int unbalancedBoards = 0; // balanced runs only, boards kept after maxCandidates misses
+    std::array<double, NUM_PLAYERS> seatWinShares = {};
+    std::vector<ArenaBotResult> bots;
+    double elapsed = 0.0; // seconds
+    std::vector<ArenaGame> results;
+};
+
+// the distinct seat orders of lineup, just lineup itself without rotation
+std::vector<std::array<int, NUM_PLAYERS>> arenaSeatOrders(const ArenaConfig &config);
+
+// plays one game from start, board of seed's run, with seats[s] in seat s
+ArenaGame playArenaGame(const GameState &start, uint64_t seed, uint64_t board,
+                        const std::array<BotConfig, NUM_PLAYERS> &seats);
+
+// plays every board in every seat order on a work-stealing pool of config.threads workers,
+// each board dealt and played through by one task
+ArenaResult runArena(const ArenaConfig &config);
@@ -0,0 +1,87 @@
+#include "balanced_board.h"
+#include "counter_rng.h"
+#include "path_solver.h"
+#include "territory_eval.h"
+
+#include <algorithm>
+#include <climits>
+
+// the squares outside each seat's territory, which its route may not enter
+static std::array<uint64_t, NUM_PLAYERS> territoryBlocks(const Territory &territory)
+{
+    std::array<uint64_t, NUM_PLAYERS> blocked;
+
+    for (int player = 0; player < NUM_PLAYERS; player++)
+        blocked[player] = ~territory.squares[player];
+
+    return blocked;
+}
+
+std::array<int, NUM_PLAYERS> seatPotentials(const GameState &state, int64_t nodeLimit)
+{
+    std::array<uint64_t, NUM_PLAYERS> blocked = territoryBlocks(computeTerritory(state));
+    std::array<int, NUM_PLAYERS> potentials;
+
+    for (int player = 0; player < NUM_PLAYERS; player++)
+        potentials[player] = solveBestRoute(state, player, blocked[player], nodeLimit).value;
+
+    return potentials;
+}
+
+bool isBalancedBoard(const GameState &state, const BalanceConfig &config)
+{
+    Territory territory = computeTerritory(state);
+    auto range = std::minmax_element(territory.value.begin(), territory.value.end());
+
+    if (*range.second - *range.first > config.tolerance + config.screenMargin)
+        return false;
+
+    std::array<uint64_t, NUM_PLAYERS> blocked = territoryBlocks(territory);
+    std::array<int, NUM_PLAYERS> bounds;
+    std::array<int, NUM_PLAYERS> order = {0, 1, 2, 3};
+
+    for (int player = 0; player < NUM_PLAYERS; player++)
+        bounds[player] = routeUpperBound(state, player, blocked[player]);
+
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return bounds[a] > bounds[b]; });
+
+    int lowest = INT_MAX;
+    int highest = INT_MIN;
+
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        int player = order[i];
+
+        // the rest come in falling order of bound, so one that cannot reach within
+        // tolerance of the best seat so far rules the board out without a search
+        if (i > 0 && bounds[player] < highest - config.tolerance)
+            return false;
+
+        int value = solveBestRoute(state, player, blocked[player], config.nodeLimit).value;
+
+        lowest = std::min(lowest, value);
+        highest = std::max(highest, value);
+
+        if (highest - lowest > config.tolerance)
+            return false;
+    }
+
+    return true;
+}
+
+int dealBalancedBoard(GameState &state, uint64_t seed, uint64_t gameIndex, const BalanceConfig &config)
+{
+    CounterRng rng(seed, gameIndex);
+    int candidates = 0;
+
+    while (candidates < config.maxCandidates)
+    {
+        candidates++;
+        initializeDealtGame(state, rng);
+
+        if (isBalancedBoard(state, config))
+            return candidates;
+    }
+
+    return 0;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "game_state.h"
+
+#include <array>
+#include <cstdint>
+
+struct BalanceConfig
+{
+    int tolerance = 8;         // largest gap in estimated points between the best and worst seat
+    int screenMargin = 4;      // how much further apart territory values may be, checked before any search
+    int64_t nodeLimit = 4096;  // per seat route search, open boards are estimated from a partial search
+    int maxCandidates = 1024;  // boards dealt before giving up and keeping the last one
+};
+
+// each seat's estimated points on a fresh board: its best walk through the squares
+// it reaches before the other pieces
+std::array<int, NUM_PLAYERS> seatPotentials(const GameState &state, int64_t nodeLimit);
+
+// true if every seat's potential is within tolerance of the others. Most boards are
+// turned away by the territory values alone, which cost a few microseconds against
+// about a millisecond for the searches. Seats are then solved from the strongest
+// bound down, and the board is rejected as soon as the solved seats spread too far
+// or an unsolved seat's bound cannot come within reach of them.
+bool isBalancedBoard(const GameState &state, const BalanceConfig &config);
+
+// board gameIndex of seed's balanced run: candidates are dealt from that board's own
+// stream until one is balanced, so a board never depends on the thread that dealt it.
+// Returns the candidates dealt, or 0 if none of maxCandidates was balanced, in which
+// case state holds the last one.
+int dealBalancedBoard(GameState &state, uint64_t seed, uint64_t gameIndex, const BalanceConfig &config);
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+inline int popCount(uint64_t mask)
+{
+#if defined(_MSC_VER)
+    return (int)__popcnt64(mask);
+#else
+    return __builtin_popcountll(mask);
+#endif
+}
+
+// index of the lowest set bit, mask must not be empty
+inline int lowestSquare(uint64_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctzll(mask);
+#endif
+}
+
+inline int popLowestSquare(uint64_t &mask)
+{
+    int square = lowestSquare(mask);
+    mask &= mask - 1;
+    return square;
+}
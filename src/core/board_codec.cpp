@@ -0,0 +1,103 @@
+#include "board_codec.h"
+#include "zobrist.h"
+
+const int TILE_CODES = 32;
+const uint8_t NO_CODE = 0xFF;
+const uint64_t CODE_MASK = (1 << TILE_CODE_BITS) - 1;
+const uint64_t UNUSED_BITS = ~uint64_t(0) << (TILES_PER_WORD * TILE_CODE_BITS);
+
+// tile byte to code and back, NO_CODE and 0 where there is no tile
+struct CodecTables
+{
+    std::array<uint8_t, 256> codeOfTile;
+    std::array<uint8_t, TILE_CODES> tileOfCode;
+};
+
+// built on first use, TILE_VALUES may not be set up yet during static initialization
+static const CodecTables &codecTables()
+{
+    static const CodecTables tables = []()
+    {
+        CodecTables built;
+        built.codeOfTile.fill(NO_CODE);
+        built.tileOfCode.fill(0);
+
+        for (int v = 0; v < (int)TILE_VALUES.size(); v++)
+        {
+            for (int w = 0; w < (int)TILE_WEIGHTS.size(); w++)
+            {
+                int code = v * (int)TILE_WEIGHTS.size() + w;
+                uint8_t tile = (uint8_t)((TILE_VALUES[v] + VALUE_BIAS) | (TILE_WEIGHTS[w] << 4));
+
+                built.codeOfTile[tile] = (uint8_t)code;
+                built.tileOfCode[code] = tile;
+            }
+        }
+
+        return built;
+    }();
+
+    return tables;
+}
+
+PackedBoard packBoard(const GameState &state)
+{
+    const CodecTables &tables = codecTables();
+    PackedBoard packed;
+
+    for (int word = 0; word < PACKED_WORDS; word++)
+    {
+        uint64_t bits = 0;
+
+        for (int i = 0; i < TILES_PER_WORD; i++)
+        {
+            uint64_t code = tables.codeOfTile[state.tiles[TILE_SQUARES[word * TILES_PER_WORD + i]]];
+            bits |= code << (i * TILE_CODE_BITS);
+        }
+
+        packed.words[word] = bits;
+    }
+
+    return packed;
+}
+
+bool unpackBoard(const PackedBoard &packed, GameState &state)
+{
+    const CodecTables &tables = codecTables();
+    std::array<uint8_t, NUM_TILES> tiles;
+    uint8_t invalid = 0;
+
+    for (int word = 0; word < PACKED_WORDS; word++)
+    {
+        uint64_t bits = packed.words[word];
+
+        if (bits & UNUSED_BITS)
+            return false;
+
+        for (int i = 0; i < TILES_PER_WORD; i++)
+        {
+            uint8_t tile = tables.tileOfCode[(bits >> (i * TILE_CODE_BITS)) & CODE_MASK];
+
+            // codes without a tile map to 0, checked once for the whole board
+            invalid |= tile == 0;
+            tiles[word * TILES_PER_WORD + i] = tile;
+        }
+    }
+
+    if (invalid)
+        return false;
+
+    setBoardTiles(state, tiles);
+    startGame(state);
+    return true;
+}
+
+uint64_t boardId(const PackedBoard &packed)
+{
+    uint64_t id = 0;
+
+    for (uint64_t word : packed.words)
+        id = splitMix64(id ^ word);
+
+    return id;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "game_state.h"
+
+#include <array>
+#include <cstdint>
+
+const int PACKED_WORDS = 5;
+const int TILES_PER_WORD = 12;
+const int TILE_CODE_BITS = 5;
+
+// A board in 40 bytes: each tile as a 5-bit code, value index * 4 + weight index into
+// TILE_VALUES and TILE_WEIGHTS, 12 to a word in TILE_SQUARES order, top 4 bits clear.
+// The start squares never change, so every board has exactly one packing and two
+// packings are equal exactly when their boards are.
+struct PackedBoard
+{
+    std::array<uint64_t, PACKED_WORDS> words;
+
+    bool operator==(const PackedBoard &other) const { return words == other.words; }
+    bool operator!=(const PackedBoard &other) const { return words != other.words; }
+};
+
+static_assert(sizeof(PackedBoard) == 40, "a packed board is five words");
+static_assert(PACKED_WORDS * TILES_PER_WORD == NUM_TILES, "every tile has a place in the packing");
+
+// the board's tiles, which must all come from TILE_VALUES and TILE_WEIGHTS
+PackedBoard packBoard(const GameState &state);
+
+// sets up a new game on the packed board. False, leaving state untouched, if a
+// tile code or the unused bits are out of range.
+bool unpackBoard(const PackedBoard &packed, GameState &state);
+
+// 64-bit id of the board for indexes and hash maps. Ids of different boards can
+// collide, about once in 2^64 pairs, so exact deduplication compares the packings.
+uint64_t boardId(const PackedBoard &packed);
@@ -0,0 +1,96 @@
+#include "bot.h"
+#include "greedy_bot.h"
+#include "move_gen.h"
+
+#include <cstdlib>
+
+int chooseMove(const GameState &state, const BotConfig &config)
+{
+    if (state.isGameOver)
+        return -1;
+
+    switch (config.type)
+    {
+    case BotType::Search:
+        return searchBestMove(state, config.search).bestMove;
+    case BotType::Mcts:
+        return searchMcts(state, config.mcts).bestMove;
+    default:
+        return getBestMove(state, getLegalMoves(state, state.piecesIndex));
+    }
+}
+
+// "name:file[:seconds]" for the network bots, the file being everything up to the last colon
+static bool splitNetworkSpec(const std::string &spec, size_t colon, std::string &path, size_t &secondsColon)
+{
+    if (colon == std::string::npos)
+        return false;
+
+    secondsColon = spec.rfind(':');
+
+    if (secondsColon == colon)
+        secondsColon = std::string::npos;
+
+    path = spec.substr(colon + 1, secondsColon == std::string::npos ? std::string::npos : secondsColon - colon - 1);
+    return !path.empty();
+}
+
+bool parseBotSpec(const std::string &spec, BotConfig &config)
+{
+    size_t colon = spec.find(':');
+    std::string name = spec.substr(0, colon);
+    std::string networkPath;
+    bool usesNetwork = name.size() > 4 && name.compare(name.size() - 4, 4, "-net") == 0;
+
+    if (usesNetwork)
+    {
+        if (!splitNetworkSpec(spec, colon, networkPath, colon))
+            return false;
+
+        name.resize(name.size() - 4);
+    }
+
+    double seconds = colon == std::string::npos ? 0.01 : std::atof(spec.c_str() + colon + 1);
+
+    if (seconds <= 0.0)
+        return false;
+
+    config = BotConfig();
+    config.search.timeBudget = seconds;
+    config.mcts.timeBudget = seconds;
+
+    if (name == "greedy")
+        config.type = BotType::Greedy;
+    else if (name == "paranoid" || name == "search")
+        config.type = BotType::Search;
+    else if (name == "maxn")
+    {
+        config.type = BotType::Search;
+        config.search.mode = SearchMode::MaxN;
+    }
+    else if (name == "mcts")
+    {
+        config.type = BotType::Mcts;
+        config.mcts.rolloutPolicy = RolloutPolicy::Greedy;
+    }
+    else if (name == "mcts-random")
+        config.type = BotType::Mcts;
+    else
+        return false;
+
+    // the greedy bot has nothing to evaluate, and MCTS leaves skip the rollout either way
+    if (usesNetwork)
+    {
+        std::shared_ptr<Network> network = std::make_shared<Network>();
+
+        if (config.type == BotType::Greedy || !loadNetwork(networkPath, *network))
+            return false;
+
+        config.network = network;
+        config.search.evaluation = Evaluation::Network;
+        config.search.network = network.get();
+        config.mcts.network = network.get();
+    }
+
+    return true;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "game_state.h"
+#include "mcts_bot.h"
+#include "search_bot.h"
+
+#include <memory>
+#include <string>
+
+enum class BotType
+{
+    Greedy,
+    Search,
+    Mcts
+};
+
+struct BotConfig
+{
+    BotType type = BotType::Search;
+    SearchConfig search;
+    MctsConfig mcts;
+    std::shared_ptr<const Network> network; // the weights the -net bots point at, shared by copies
+};
+
+// the move the bot plays for the current player, -1 once the game is over
+int chooseMove(const GameState &state, const BotConfig &config);
+
+// reads a bot description such as "greedy", "paranoid:0.05", "maxn", "mcts:0.1" or
+// "mcts-random", the number being seconds per move. "paranoid-net:file", "maxn-net:file"
+// and "mcts-net:file", each with an optional ":seconds" after the file, evaluate with the
+// network saved in file. False for an unknown bot or a network that does not load.
+bool parseBotSpec(const std::string &spec, BotConfig &config);
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "zobrist.h"
+
+#include <cstdint>
+#include <random>
+
+// the key of stream index under seed, distinct for every index of one seed
+inline uint64_t streamKey(uint64_t seed, uint64_t index)
+{
+    return splitMix64(splitMix64(seed) ^ index);
+}
+
+// Counter-based generator: draw n of a stream is splitMix64 of key + n steps, so it
+// holds no state beyond the counter. Any game of a run can be regenerated from
+// (seed, game index) alone, and threads each make their own without sharing anything.
+struct CounterRng
+{
+    uint64_t key;
+    uint64_t counter = 0;
+
+    CounterRng(uint64_t seed, uint64_t index) : key(streamKey(seed, index)) {}
+
+    uint64_t next() { return splitMix64(key + 0x9E3779B97F4A7C15ULL * counter++); }
+
+    // uniform in [0, n), by multiply and shift, rejecting the few draws that would bias it
+    uint32_t below(uint32_t n) { return belowFrom((uint32_t)next(), n); }
+
+    // below, starting from 32 bits the caller already drew, so one draw can serve two picks
+    uint32_t belowFrom(uint32_t bits, uint32_t n)
+    {
+        uint64_t product = (uint64_t)bits * n;
+
+        if ((uint32_t)product < n)
+        {
+            uint32_t threshold = (0u - n) % n;
+
+            while ((uint32_t)product < threshold)
+                product = (uint64_t)(uint32_t)next() * n;
+        }
+
+        return (uint32_t)(product >> 32);
+    }
+};
+
+// a fresh seed from the operating system, for runs that need not repeat
+inline uint64_t randomSeed()
+{
+    std::random_device device;
+    return ((uint64_t)device() << 32) ^ device();
+}
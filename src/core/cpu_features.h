@@ -0,0 +1,19 @@
+#pragma once
+
+// AVX2 code paths are compiled per function with a target attribute and picked
+// at run time, so the rest of the build needs no special flags
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CORE_HAS_AVX2 1
+#define AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+
+inline bool cpuHasAvx2()
+{
+#ifdef CORE_HAS_AVX2
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    return hasAvx2;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,138 @@
+#include "cpu_worker.h"
+#include "bitboard.h"
+#include "move_gen.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <thread>
+
+// the ponder spends this long on the human's move before turning to the replies
+const double PONDER_PREDICTION_TIME = 0.1;
+
+// reply searches double their time slice up to this, so the deadline never overflows
+const double PONDER_MAX_SLICE = 4.0;
+
+CpuWorker::~CpuWorker()
+{
+    cancel();
+}
+
+void CpuWorker::start(const GameState &state, const BotConfig &config, double minDuration)
+{
+    cancel();
+
+    std::shared_ptr<Job> token = std::make_shared<Job>();
+    job = token;
+    pondering = false;
+
+    pending = std::async(std::launch::async, [state, config, minDuration, token]()
+                         {
+                             auto startTime = std::chrono::steady_clock::now();
+                             BotConfig botConfig = config;
+                             botConfig.search.stop = &token->cancel;
+                             botConfig.mcts.stop = &token->cancel;
+
+                             int move = chooseMove(state, botConfig);
+
+                             while (!token->cancel.load() &&
+                                    std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count() < minDuration)
+                                 std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+                             return token->cancel.load() ? -1 : move;
+                         });
+}
+
+// predicted move first, then the replies to each human move in turn with a doubling
+// time slice. Only the alpha-beta bot keeps anything between searches, its table,
+// and the whole ponder writes it as one generation so no reply ages out another.
+static void ponderReplies(const GameState &state, SearchConfig config, const std::atomic<bool> &cancel)
+{
+    config.stop = &cancel;
+    config.timeBudget = PONDER_PREDICTION_TIME;
+
+    if (config.table)
+    {
+        config.table->newSearch();
+        config.newGeneration = false;
+    }
+
+    int prediction = searchBestMove(state, config).bestMove;
+
+    if (cancel.load() || prediction < 0)
+        return;
+
+    std::array<int, 8> moves;
+    int count = 0;
+    uint64_t legalMoves = getLegalMoves(state, state.piecesIndex) & ~squareBit(prediction);
+
+    moves[count++] = prediction;
+
+    while (legalMoves)
+        moves[count++] = popLowestSquare(legalMoves);
+
+    std::array<bool, 8> resolved = {};
+    int unresolved = count;
+
+    for (double slice = 0.05; unresolved > 0 && !cancel.load(); slice = std::min(slice * 2, PONDER_MAX_SLICE))
+    {
+        config.timeBudget = slice;
+
+        for (int i = 0; i < count && !cancel.load(); i++)
+        {
+            if (resolved[i])
+                continue;
+
+            GameState reply = state;
+            playMove(reply, moves[i]);
+
+            // a forced reply has nothing to search
+            if (reply.isGameOver || popCount(getLegalMoves(reply, reply.piecesIndex)) == 1 ||
+                searchBestMove(reply, config).isExact)
+            {
+                resolved[i] = true;
+                unresolved--;
+            }
+        }
+    }
+}
+
+void CpuWorker::ponder(const GameState &state, const BotConfig &config)
+{
+    cancel();
+
+    std::shared_ptr<Job> token = std::make_shared<Job>();
+    job = token;
+    pondering = true;
+
+    pending = std::async(std::launch::async, [state, config, token]()
+                         {
+                             if (config.type == BotType::Search && !state.isGameOver)
+                                 ponderReplies(state, config.search, token->cancel);
+
+                             return -1;
+                         });
+}
+
+bool CpuWorker::poll(int &move)
+{
+    if (!pending.valid() || pondering ||
+        pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return false;
+
+    move = pending.get();
+    job.reset();
+    return true;
+}
+
+void CpuWorker::cancel()
+{
+    if (!pending.valid())
+        return;
+
+    job->cancel.store(true);
+    pending.wait();
+    pending = std::future<int>();
+    job.reset();
+    pondering = false;
+}
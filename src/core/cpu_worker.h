@@ -0,0 +1,43 @@
+#pragma once
+
+#include "bot.h"
+#include "game_state.h"
+
+#include <atomic>
+#include <future>
+#include <memory>
+
+// computes bot moves on a background thread so the caller's frame loop never blocks
+class CpuWorker
+{
+public:
+    ~CpuWorker();
+
+    // starts thinking about state's current player, cancelling any earlier request.
+    // The move is held back until at least minDuration seconds have passed.
+    void start(const GameState &state, const BotConfig &config, double minDuration = 0.0);
+
+    // thinks ahead while state's current player, a human, is choosing a move: predicts
+    // that move and searches the CPU replies to every candidate into the shared table.
+    // Runs until cancelled or until every reply is searched to the end of the game.
+    void ponder(const GameState &state, const BotConfig &config);
+
+    // true once, when the move is ready, -1 if it was cancelled. Never true for a ponder.
+    bool poll(int &move);
+
+    // asks the running search to stop and waits for it to return
+    void cancel();
+
+    bool isThinking() const { return pending.valid() && !pondering; }
+    bool isPondering() const { return pending.valid() && pondering; }
+
+private:
+    struct Job
+    {
+        std::atomic<bool> cancel{false};
+    };
+
+    std::future<int> pending;
+    std::shared_ptr<Job> job;
+    bool pondering = false;
+};
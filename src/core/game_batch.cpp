@@ -0,0 +1,444 @@
+#include "game_batch.h"
+#include "cpu_features.h"
+#include "move_gen.h"
+
+#include <algorithm>
+
+const int WEIGHT_MASK_HALVES = (MAX_TILE_WEIGHT + 1) * 2;
+
+void resizeBatch(GameBatch &batch, int count)
+{
+    batch.count = count;
+    batch.capacity = (count + BATCH_LANES - 1) / BATCH_LANES * BATCH_LANES;
+
+    batch.tiles.assign((size_t)batch.capacity * NUM_SQUARES, 0);
+    batch.weightMasks.assign((size_t)batch.capacity * WEIGHT_MASK_HALVES, 0);
+    batch.visitedLow.assign(batch.capacity, ~0u);
+    batch.visitedHigh.assign(batch.capacity, ~0u);
+
+    for (int player = 0; player < NUM_PLAYERS; player++)
+    {
+        batch.squares[player].assign(batch.capacity, 0);
+        batch.weights[player].assign(batch.capacity, 0);
+        batch.scores[player].assign(batch.capacity, 0);
+    }
+
+    batch.activeMask.assign(batch.capacity, 0);
+    batch.piecesIndex.assign(batch.capacity, 0);
+}
+
+void loadBatchGame(GameBatch &batch, int game, const GameState &state)
+{
+    for (int square = 0; square < NUM_SQUARES; square++)
+        batch.tiles[(size_t)game * NUM_SQUARES + square] = state.tiles[square];
+
+    for (int k = 0; k <= MAX_TILE_WEIGHT; k++)
+    {
+        batch.weightMasks[(size_t)game * WEIGHT_MASK_HALVES + k * 2] = (uint32_t)state.weightMasks[k];
+        batch.weightMasks[(size_t)game * WEIGHT_MASK_HALVES + k * 2 + 1] = (uint32_t)(state.weightMasks[k] >> 32);
+    }
+
+    batch.visitedLow[game] = (uint32_t)state.visited;
+    batch.visitedHigh[game] = (uint32_t)(state.visited >> 32);
+
+    for (int player = 0; player < NUM_PLAYERS; player++)
+    {
+        batch.squares[player][game] = state.pieces[player].square;
+        batch.weights[player][game] = state.pieces[player].currentWeight;
+        batch.scores[player][game] = state.pieces[player].score;
+    }
+
+    batch.activeMask[game] = state.isGameOver ? 0 : state.activeMask;
+    batch.piecesIndex[game] = state.piecesIndex;
+}
+
+uint8_t batchWinnerMask(const GameBatch &batch, int game)
+{
+    int maxValue = batch.scores[0][game];
+    int minWeight = MAX_WEIGHT;
+    uint8_t winnerMask = 0;
+
+    for (int player = 1; player < NUM_PLAYERS; player++)
+        maxValue = std::max(maxValue, batch.scores[player][game]);
+
+    for (int player = 0; player < NUM_PLAYERS; player++)
+    {
+        if (batch.scores[player][game] == maxValue)
+            minWeight = std::min(minWeight, batch.weights[player][game]);
+    }
+
+    for (int player = 0; player < NUM_PLAYERS; player++)
+    {
+        if (batch.scores[player][game] == maxValue && batch.weights[player][game] == minWeight)
+            winnerMask |= 1 << player;
+    }
+
+    return winnerMask;
+}
+
+// scalar kernel, the rules of playMove and finishTurn on one lane
+
+static uint64_t laneLegalMoves(const GameBatch &batch, int game, int player)
+{
+    uint64_t visited = (uint64_t)batch.visitedHigh[game] << 32 | batch.visitedLow[game];
+    int k = std::min(MAX_WEIGHT - batch.weights[player][game], MAX_TILE_WEIGHT);
+    const uint32_t *masks = &batch.weightMasks[(size_t)game * WEIGHT_MASK_HALVES + k * 2];
+    uint64_t weightMask = (uint64_t)masks[1] << 32 | masks[0];
+
+    return KING_MOVES[batch.squares[player][game]] & ~visited & weightMask;
+}
+
+// the same choice as getBestMove
+static int laneBestMove(const GameBatch &batch, int game, uint64_t legalMoves)
+{
+    const int32_t *tiles = &batch.tiles[(size_t)game * NUM_SQUARES];
+    int maxValue = -10;
+    int minWeight = 5;
+    int bestMove = -1;
+
+    while (legalMoves)
+    {
+        int square = popLowestSquare(legalMoves);
+        int value = (tiles[square] & 0xF) - VALUE_BIAS;
+        int weight = tiles[square] >> 4;
+
+        if (value > maxValue || (value == maxValue && weight <= minWeight))
+        {
+            maxValue = value;
+            minWeight = weight;
+            bestMove = square;
+        }
+    }
+
+    return bestMove;
+}
+
+static void playLaneMove(GameBatch &batch, int game, int square)
+{
+    int player = batch.piecesIndex[game];
+    int tile = batch.tiles[(size_t)game * NUM_SQUARES + square];
+
+    batch.squares[player][game] = square;
+    batch.weights[player][game] += tile >> 4;
+    batch.scores[player][game] += (tile & 0xF) - VALUE_BIAS;
+
+    if (square < 32)
+        batch.visitedLow[game] |= 1u << square;
+    else
+        batch.visitedHigh[game] |= 1u << (square - 32);
+
+    if (laneLegalMoves(batch, game, player) == 0)
+        batch.activeMask[game] &= ~(1 << player);
+
+    while (batch.activeMask[game] != 0)
+    {
+        do
+        {
+            player = (player + 1) % NUM_PLAYERS;
+
+        } while (!(batch.activeMask[game] & (1 << player)));
+
+        batch.piecesIndex[game] = player;
+
+        if (laneLegalMoves(batch, game, player) != 0)
+            return;
+
+        batch.activeMask[game] &= ~(1 << player);
+    }
+}
+
+static void greedyMovesScalar(const GameBatch &batch, std::vector<int> &moves)
+{
+    for (int game = 0; game < batch.capacity; game++)
+    {
+        if (batch.activeMask[game] == 0)
+            moves[game] = -1;
+        else
+            moves[game] = laneBestMove(batch, game, laneLegalMoves(batch, game, batch.piecesIndex[game]));
+    }
+}
+
+static void playGreedyScalar(GameBatch &batch)
+{
+    for (int game = 0; game < batch.capacity; game++)
+    {
+        while (batch.activeMask[game] != 0)
+            playLaneMove(batch, game, laneBestMove(batch, game, laneLegalMoves(batch, game, batch.piecesIndex[game])));
+    }
+}
+
+#ifdef CORE_HAS_AVX2
+
+// AVX2 kernel, the scalar rules above for eight games per instruction
+
+// the greedy move of the player to move in eight lanes, with what the lanes need to play it
+struct LaneChoice
+{
+    __m256i alive;
+    __m256i player;
+    __m256i square;
+    __m256i weight;
+    __m256i score;
+    __m256i move; // -1 where there is no game to move in
+    __m256i value;
+    __m256i tileWeight;
+};
+
+AVX2_TARGET static inline __m256i loadLanes(const int32_t *field)
+{
+    return _mm256_loadu_si256((const __m256i *)field);
+}
+
+AVX2_TARGET static inline __m256i loadLanes(const uint32_t *field)
+{
+    return _mm256_loadu_si256((const __m256i *)field);
+}
+
+AVX2_TARGET static inline void storeLanes(int32_t *field, __m256i value)
+{
+    _mm256_storeu_si256((__m256i *)field, value);
+}
+
+AVX2_TARGET static inline void storeLanes(uint32_t *field, __m256i value)
+{
+    _mm256_storeu_si256((__m256i *)field, value);
+}
+
+// field[player] in every lane, players differ between lanes
+AVX2_TARGET static inline __m256i selectPlayer(const std::array<std::vector<int32_t>, NUM_PLAYERS> &field,
+                                               __m256i player, int base)
+{
+    __m256i result = loadLanes(&field[0][base]);
+
+    for (int p = 1; p < NUM_PLAYERS; p++)
+    {
+        __m256i isPlayer = _mm256_cmpeq_epi32(player, _mm256_set1_epi32(p));
+        result = _mm256_blendv_epi8(result, loadLanes(&field[p][base]), isPlayer);
+    }
+
+    return result;
+}
+
+AVX2_TARGET static inline void updatePlayer(std::array<std::vector<int32_t>, NUM_PLAYERS> &field,
+                                            __m256i player, int base, __m256i value, __m256i lanes)
+{
+    for (int p = 0; p < NUM_PLAYERS; p++)
+    {
+        __m256i isPlayer = _mm256_and_si256(_mm256_cmpeq_epi32(player, _mm256_set1_epi32(p)), lanes);
+        storeLanes(&field[p][base], _mm256_blendv_epi8(loadLanes(&field[p][base]), value, isPlayer));
+    }
+}
+
+// all ones in the lanes where a piece on square with the remaining capacity can move
+AVX2_TARGET static inline __m256i hasLegalMove(const GameBatch &batch, __m256i game, __m256i square, __m256i remaining,
+                                               __m256i visitedLow, __m256i visitedHigh)
+{
+    const int *kingMoves = (const int *)KING_MOVES.data();
+    const int *weightMasks = (const int *)batch.weightMasks.data();
+    __m256i kingIndex = _mm256_slli_epi32(square, 1);
+    __m256i k = _mm256_min_epi32(remaining, _mm256_set1_epi32(MAX_TILE_WEIGHT));
+    __m256i maskIndex = _mm256_add_epi32(_mm256_mullo_epi32(game, _mm256_set1_epi32(WEIGHT_MASK_HALVES)),
+                                         _mm256_slli_epi32(k, 1));
+    __m256i one = _mm256_set1_epi32(1);
+
+    __m256i low = _mm256_andnot_si256(visitedLow, _mm256_i32gather_epi32(kingMoves, kingIndex, 4));
+    __m256i high = _mm256_andnot_si256(visitedHigh, _mm256_i32gather_epi32(kingMoves, _mm256_add_epi32(kingIndex, one), 4));
+
+    low = _mm256_and_si256(low, _mm256_i32gather_epi32(weightMasks, maskIndex, 4));
+    high = _mm256_and_si256(high, _mm256_i32gather_epi32(weightMasks, _mm256_add_epi32(maskIndex, one), 4));
+
+    __m256i none = _mm256_cmpeq_epi32(_mm256_or_si256(low, high), _mm256_setzero_si256());
+    return _mm256_xor_si256(none, _mm256_set1_epi32(-1));
+}
+
+// scans the eight king directions in rising square order, so ties resolve as in getBestMove
+AVX2_TARGET static LaneChoice chooseGreedyAvx2(const GameBatch &batch, int base)
+{
+    static const int DIRECTIONS[8][2] = {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}};
+
+    LaneChoice choice;
+    __m256i zero = _mm256_setzero_si256();
+    __m256i game = _mm256_add_epi32(_mm256_set1_epi32(base), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    __m256i visitedLow = loadLanes(&batch.visitedLow[base]);
+    __m256i visitedHigh = loadLanes(&batch.visitedHigh[base]);
+
+    choice.alive = _mm256_xor_si256(_mm256_cmpeq_epi32(loadLanes(&batch.activeMask[base]), zero), _mm256_set1_epi32(-1));
+    choice.player = loadLanes(&batch.piecesIndex[base]);
+    choice.square = selectPlayer(batch.squares, choice.player, base);
+    choice.weight = selectPlayer(batch.weights, choice.player, base);
+    choice.score = selectPlayer(batch.scores, choice.player, base);
+    choice.move = _mm256_set1_epi32(-1);
+    choice.value = _mm256_set1_epi32(-10);
+    choice.tileWeight = _mm256_set1_epi32(5);
+
+    __m256i remaining = _mm256_sub_epi32(_mm256_set1_epi32(MAX_WEIGHT), choice.weight);
+    __m256i row = _mm256_srai_epi32(choice.square, 3);
+    __m256i col = _mm256_and_si256(choice.square, _mm256_set1_epi32(BOARD_SIZE - 1));
+    __m256i tileBase = _mm256_slli_epi32(game, 6);
+    __m256i lastRow = _mm256_set1_epi32(BOARD_SIZE);
+    __m256i minusOne = _mm256_set1_epi32(-1);
+
+    static_assert(BOARD_SIZE == 8 && NUM_SQUARES == 64, "the AVX2 kernel assumes an 8x8 board");
+
+    for (const int *direction : DIRECTIONS)
+    {
+        __m256i toRow = _mm256_add_epi32(row, _mm256_set1_epi32(direction[0]));
+        __m256i toCol = _mm256_add_epi32(col, _mm256_set1_epi32(direction[1]));
+        __m256i onBoard = _mm256_and_si256(_mm256_and_si256(_mm256_cmpgt_epi32(toRow, minusOne), _mm256_cmpgt_epi32(lastRow, toRow)),
+                                           _mm256_and_si256(_mm256_cmpgt_epi32(toCol, minusOne), _mm256_cmpgt_epi32(lastRow, toCol)));
+        onBoard = _mm256_and_si256(onBoard, choice.alive);
+
+        __m256i target = _mm256_and_si256(_mm256_add_epi32(_mm256_slli_epi32(toRow, 3), toCol), onBoard);
+        __m256i tile = _mm256_mask_i32gather_epi32(zero, batch.tiles.data(), _mm256_add_epi32(tileBase, target), onBoard, 4);
+        __m256i value = _mm256_sub_epi32(_mm256_and_si256(tile, _mm256_set1_epi32(0xF)), _mm256_set1_epi32(VALUE_BIAS));
+        __m256i weight = _mm256_srli_epi32(tile, 4);
+
+        // shifts of 32 or more give zero, so each half only answers for its own squares
+        __m256i visited = _mm256_or_si256(_mm256_srlv_epi32(visitedLow, target),
+                                          _mm256_srlv_epi32(visitedHigh, _mm256_sub_epi32(target, _mm256_set1_epi32(32))));
+        visited = _mm256_and_si256(visited, _mm256_set1_epi32(1));
+
+        __m256i legal = _mm256_andnot_si256(_mm256_cmpgt_epi32(weight, remaining),
+                                            _mm256_and_si256(onBoard, _mm256_cmpeq_epi32(visited, zero)));
+        __m256i better = _mm256_or_si256(_mm256_cmpgt_epi32(value, choice.value),
+                                         _mm256_andnot_si256(_mm256_cmpgt_epi32(weight, choice.tileWeight),
+                                                             _mm256_cmpeq_epi32(value, choice.value)));
+        __m256i take = _mm256_and_si256(legal, better);
+
+        choice.move = _mm256_blendv_epi8(choice.move, target, take);
+        choice.value = _mm256_blendv_epi8(choice.value, value, take);
+        choice.tileWeight = _mm256_blendv_epi8(choice.tileWeight, weight, take);
+    }
+
+    return choice;
+}
+
+AVX2_TARGET static void greedyMovesAvx2(const GameBatch &batch, std::vector<int> &moves)
+{
+    for (int base = 0; base < batch.capacity; base += BATCH_LANES)
+        storeLanes(&moves[base], chooseGreedyAvx2(batch, base).move);
+}
+
+// plays one greedy move in each live lane, then passes the turn as finishTurn does
+AVX2_TARGET static bool stepGreedyAvx2(GameBatch &batch, int base)
+{
+    LaneChoice choice = chooseGreedyAvx2(batch, base);
+
+    if (_mm256_testz_si256(choice.alive, choice.alive))
+        return false;
+
+    __m256i zero = _mm256_setzero_si256();
+    __m256i one = _mm256_set1_epi32(1);
+    __m256i ones = _mm256_set1_epi32(-1);
+    __m256i game = _mm256_add_epi32(_mm256_set1_epi32(base), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    __m256i moved = _mm256_cmpgt_epi32(choice.move, ones);
+    __m256i square = _mm256_blendv_epi8(choice.square, choice.move, moved);
+    __m256i weight = _mm256_add_epi32(choice.weight, _mm256_and_si256(choice.tileWeight, moved));
+    __m256i score = _mm256_add_epi32(choice.score, _mm256_and_si256(choice.value, moved));
+    __m256i visitedLow = loadLanes(&batch.visitedLow[base]);
+    __m256i visitedHigh = loadLanes(&batch.visitedHigh[base]);
+    __m256i activeMask = loadLanes(&batch.activeMask[base]);
+    __m256i player = choice.player;
+
+    visitedLow = _mm256_or_si256(visitedLow, _mm256_and_si256(_mm256_sllv_epi32(one, choice.move), moved));
+    visitedHigh = _mm256_or_si256(visitedHigh, _mm256_and_si256(_mm256_sllv_epi32(one, _mm256_sub_epi32(choice.move, _mm256_set1_epi32(32))), moved));
+
+    updatePlayer(batch.squares, player, base, square, moved);
+    updatePlayer(batch.weights, player, base, weight, moved);
+    updatePlayer(batch.scores, player, base, score, moved);
+
+    // a mover with no square left drops out
+    __m256i remaining = _mm256_sub_epi32(_mm256_set1_epi32(MAX_WEIGHT), weight);
+    __m256i boxedIn = _mm256_andnot_si256(hasLegalMove(batch, game, square, remaining, visitedLow, visitedHigh), moved);
+    activeMask = _mm256_andnot_si256(_mm256_and_si256(_mm256_sllv_epi32(one, player), boxedIn), activeMask);
+
+    __m256i pending = moved;
+
+    while (true)
+    {
+        pending = _mm256_andnot_si256(_mm256_cmpeq_epi32(activeMask, zero), pending);
+
+        if (_mm256_testz_si256(pending, pending))
+            break;
+
+        // the next active player, at least one step on
+        __m256i advance = pending;
+
+        do
+        {
+            __m256i next = _mm256_and_si256(_mm256_add_epi32(player, one), _mm256_set1_epi32(NUM_PLAYERS - 1));
+            player = _mm256_blendv_epi8(player, next, advance);
+
+            __m256i isActive = _mm256_and_si256(_mm256_srlv_epi32(activeMask, player), one);
+            advance = _mm256_and_si256(pending, _mm256_cmpeq_epi32(isActive, zero));
+
+        } while (!_mm256_testz_si256(advance, advance));
+
+        remaining = _mm256_sub_epi32(_mm256_set1_epi32(MAX_WEIGHT), selectPlayer(batch.weights, player, base));
+        square = selectPlayer(batch.squares, player, base);
+
+        // a piece boxed in by the others drops out and the turn passes on again
+        pending = _mm256_andnot_si256(hasLegalMove(batch, game, square, remaining, visitedLow, visitedHigh), pending);
+        activeMask = _mm256_andnot_si256(_mm256_and_si256(_mm256_sllv_epi32(one, player), pending), activeMask);
+    }
+
+    storeLanes(&batch.visitedLow[base], visitedLow);
+    storeLanes(&batch.visitedHigh[base], visitedHigh);
+    storeLanes(&batch.activeMask[base], activeMask);
+    storeLanes(&batch.piecesIndex[base], player);
+    return true;
+}
+
+AVX2_TARGET static void playGreedyAvx2(GameBatch &batch)
+{
+    // one block of lanes at a time, so its games stay in cache until they finish
+    for (int base = 0; base < batch.capacity; base += BATCH_LANES)
+    {
+        while (stepGreedyAvx2(batch, base))
+            ;
+    }
+}
+
+#endif
+
+BatchKernel detectBatchKernel()
+{
+    return cpuHasAvx2() ? BatchKernel::Avx2 : BatchKernel::Scalar;
+}
+
+static BatchKernel resolveKernel(BatchKernel kernel)
+{
+    // Avx2 on a CPU without it falls back too, rather than faulting
+    if (kernel == BatchKernel::Scalar)
+        return kernel;
+
+    return detectBatchKernel();
+}
+
+void greedyBatchMoves(const GameBatch &batch, std::vector<int> &moves, BatchKernel kernel)
+{
+    moves.resize(batch.capacity);
+
+#ifdef CORE_HAS_AVX2
+    if (resolveKernel(kernel) == BatchKernel::Avx2)
+    {
+        greedyMovesAvx2(batch, moves);
+        return;
+    }
+#endif
+
+    greedyMovesScalar(batch, moves);
+}
+
+void playGreedyBatch(GameBatch &batch, BatchKernel kernel)
+{
+#ifdef CORE_HAS_AVX2
+    if (resolveKernel(kernel) == BatchKernel::Avx2)
+    {
+        playGreedyAvx2(batch);
+        return;
+    }
+#endif
+
+    playGreedyScalar(batch);
+}
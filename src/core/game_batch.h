@@ -0,0 +1,50 @@
+#pragma once
+
+#include "game_state.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// games per vector step, eight 32-bit lanes of an AVX2 register
+const int BATCH_LANES = 8;
+
+enum class BatchKernel
+{
+    Auto,   // AVX2 when the CPU has it, scalar otherwise
+    Scalar,
+    Avx2
+};
+
+// many independent games in structure-of-arrays form, one lane per game.
+// Bitboards are split into 32-bit halves so every field fits a 32-bit lane.
+struct GameBatch
+{
+    int count = 0;    // games in the batch
+    int capacity = 0; // count rounded up to a whole number of vector steps
+
+    std::vector<int32_t> tiles;           // NUM_SQUARES per game, packed as in GameState
+    std::vector<uint32_t> weightMasks;    // (MAX_TILE_WEIGHT + 1) * 2 halves per game
+    std::vector<uint32_t> visitedLow;
+    std::vector<uint32_t> visitedHigh;
+    std::array<std::vector<int32_t>, NUM_PLAYERS> squares;
+    std::array<std::vector<int32_t>, NUM_PLAYERS> weights;
+    std::array<std::vector<int32_t>, NUM_PLAYERS> scores;
+    std::vector<int32_t> activeMask; // 0 once the game is over, padding lanes stay 0
+    std::vector<int32_t> piecesIndex;
+};
+
+void resizeBatch(GameBatch &batch, int count);
+void loadBatchGame(GameBatch &batch, int game, const GameState &state);
+
+// the greedy player's move for the player to move in every game, -1 for finished games
+void greedyBatchMoves(const GameBatch &batch, std::vector<int> &moves, BatchKernel kernel = BatchKernel::Auto);
+
+// plays every seat of every game greedily to the end, the same games playGreedyGame plays
+void playGreedyBatch(GameBatch &batch, BatchKernel kernel = BatchKernel::Auto);
+
+// winners of a finished game, by the rules of setWinner
+uint8_t batchWinnerMask(const GameBatch &batch, int game);
+
+// the kernel Auto picks on this CPU
+BatchKernel detectBatchKernel();
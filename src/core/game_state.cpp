@@ -0,0 +1,410 @@
+#include "game_state.h"
+#include "bitboard.h"
+#include "counter_rng.h"
+#include "move_gen.h"
+#include "zobrist.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+const std::vector<int> TILE_VALUES = {-4, -2, 2, 4, 6, 8};
+const std::vector<int> TILE_WEIGHTS = {1, 2, 3, 4};
+
+// what dealBoard shuffles: every tile's biased value nibble or weight, equal copies of each
+static std::array<uint8_t, NUM_TILES> makePool(const std::vector<int> &values, int bias)
+{
+    std::array<uint8_t, NUM_TILES> pool = {};
+    int copies = NUM_TILES / (int)values.size();
+
+    for (int i = 0; i < NUM_TILES; i++)
+        pool[i] = (uint8_t)(values[i / copies] + bias);
+
+    return pool;
+}
+
+static const std::array<uint8_t, NUM_TILES> VALUE_POOL = makePool(TILE_VALUES, VALUE_BIAS);
+static const std::array<uint8_t, NUM_TILES> WEIGHT_POOL = makePool(TILE_WEIGHTS, 0);
+
+int squareOwner(const GameState &state, int square)
+{
+    for (int player = 0; player < NUM_PLAYERS; player++)
+    {
+        if (state.occupancy[player] & squareBit(square))
+            return player;
+    }
+
+    return -1;
+}
+
+bool isStartSquare(int row, int col)
+{
+    return (row == 1 && col == 1) ||
+           (row == 1 && col == BOARD_SIZE - 2) ||
+           (row == BOARD_SIZE - 2 && col == 1) ||
+           (row == BOARD_SIZE - 2 && col == BOARD_SIZE - 2);
+}
+
+std::vector<int> createIntVector(const std::vector<int> &vector, int numOfInstances)
+{
+    std::vector<int> intVector;
+
+    for (int i : vector)
+    {
+        for (int j = 0; j < numOfInstances; j++)
+        {
+            intVector.push_back(i);
+        }
+    }
+
+    return intVector;
+}
+
+// Fisher-Yates by hand, std::shuffle may draw differently on another standard library
+void randomizeVector(std::vector<int> &vector, CounterRng &rng)
+{
+    for (size_t i = vector.size(); i > 1; i--)
+        std::swap(vector[i - 1], vector[rng.below((uint32_t)i)]);
+}
+
+void fillBoard(GameState &state,
+               const std::vector<int> &valuesVec,
+               const std::vector<int> &weightsVec)
+{
+    int vectorIndex = 0;
+
+    state.visited = 0;
+    state.occupancy = {};
+    state.weightMasks = {};
+
+    // fill board with random values and weights
+    for (int row = 0; row < BOARD_SIZE; row++)
+    {
+        for (int col = 0; col < BOARD_SIZE; col++)
+        {
+            int square = squareIndex(row, col);
+
+            if (isStartSquare(row, col))
+            {
+                state.tiles[square] = VALUE_BIAS;
+                state.visited |= squareBit(square);
+                continue;
+            }
+
+            state.tiles[square] = (uint8_t)((valuesVec[vectorIndex] + VALUE_BIAS) |
+                                            (weightsVec[vectorIndex] << 4));
+
+            vectorIndex++;
+        }
+    }
+
+    for (int square = 0; square < NUM_SQUARES; square++)
+    {
+        for (int k = tileWeight(state, square); k <= MAX_TILE_WEIGHT; k++)
+            state.weightMasks[k] |= squareBit(square);
+    }
+}
+
+static std::array<uint8_t, NUM_TILES> makeTileSquares()
+{
+    std::array<uint8_t, NUM_TILES> squares = {};
+    int count = 0;
+
+    for (int square = 0; square < NUM_SQUARES; square++)
+    {
+        if (!isStartSquare(squareRow(square), squareCol(square)))
+            squares[count++] = (uint8_t)square;
+    }
+
+    return squares;
+}
+
+const std::array<uint8_t, NUM_TILES> TILE_SQUARES = makeTileSquares();
+
+static const std::array<uint8_t, NUM_PLAYERS> START_SQUARES = {
+    (uint8_t)squareIndex(1, 1), (uint8_t)squareIndex(1, BOARD_SIZE - 2),
+    (uint8_t)squareIndex(BOARD_SIZE - 2, 1), (uint8_t)squareIndex(BOARD_SIZE - 2, BOARD_SIZE - 2)};
+
+static uint64_t makeStartMask()
+{
+    uint64_t mask = 0;
+
+    for (int square : START_SQUARES)
+        mask |= squareBit(square);
+
+    return mask;
+}
+
+static const uint64_t START_MASK = makeStartMask();
+
+const uint64_t BYTE_LOW_BITS = 0x0101010101010101ULL;
+const uint64_t BYTE_HIGH_BITS = 0x8080808080808080ULL;
+
+// moves the low bit of each byte i to bit 56 + i, no two partial products overlap
+const uint64_t GATHER_BYTE_BITS = 0x0102040810204080ULL;
+
+void setBoardTiles(GameState &state, const std::array<uint8_t, NUM_TILES> &tiles)
+{
+    for (int i = 0; i < NUM_TILES; i++)
+        state.tiles[TILE_SQUARES[i]] = tiles[i];
+
+    for (int square : START_SQUARES)
+        state.tiles[square] = VALUE_BIAS;
+
+    state.visited = START_MASK;
+    state.occupancy = {};
+    state.weightMasks = {};
+
+    // a row of eight tiles at a time: each byte of 0x80 + k - weight keeps its top
+    // bit exactly when the weight is at most k, and one multiply gathers the eight
+    for (int row = 0; row < BOARD_SIZE; row++)
+    {
+        uint64_t word;
+        std::memcpy(&word, &state.tiles[row * BOARD_SIZE], sizeof(word));
+        uint64_t weights = (word >> 4) & (BYTE_LOW_BITS * 0x0F);
+
+        for (int k = 0; k <= MAX_TILE_WEIGHT; k++)
+        {
+            uint64_t light = (BYTE_LOW_BITS * (0x80 + k) - weights) & BYTE_HIGH_BITS;
+            state.weightMasks[k] |= (((light >> 7) * GATHER_BYTE_BITS) >> 56) << (row * BOARD_SIZE);
+        }
+    }
+}
+
+// Fisher-Yates over both pools at once, each tile taking its value and weight from
+// the two halves of one draw, so the board is built in place without any vectors
+void dealBoard(GameState &state, CounterRng &rng)
+{
+    std::array<uint8_t, NUM_TILES> values = VALUE_POOL;
+    std::array<uint8_t, NUM_TILES> weights = WEIGHT_POOL;
+    std::array<uint8_t, NUM_TILES> tiles;
+
+    for (int i = NUM_TILES - 1; i >= 0; i--)
+    {
+        uint64_t draw = rng.next();
+        uint32_t valueIndex = rng.belowFrom((uint32_t)draw, (uint32_t)i + 1);
+        uint32_t weightIndex = rng.belowFrom((uint32_t)(draw >> 32), (uint32_t)i + 1);
+
+        tiles[i] = (uint8_t)(values[valueIndex] | (weights[weightIndex] << 4));
+        values[valueIndex] = values[i];
+        weights[weightIndex] = weights[i];
+    }
+
+    setBoardTiles(state, tiles);
+}
+
+void startGame(GameState &state)
+{
+    state.pieces[0] = {(uint8_t)squareIndex(1, 1), 0, 0};                           // player 1
+    state.pieces[1] = {(uint8_t)squareIndex(1, BOARD_SIZE - 2), 0, 0};              // player 2
+    state.pieces[2] = {(uint8_t)squareIndex(BOARD_SIZE - 2, 1), 0, 0};              // player 3
+    state.pieces[3] = {(uint8_t)squareIndex(BOARD_SIZE - 2, BOARD_SIZE - 2), 0, 0}; // player 4
+
+    state.activeMask = (1 << NUM_PLAYERS) - 1;
+    state.winnerMask = 0;
+    state.piecesIndex = 0;
+    state.isGameOver = false;
+    state.isTie = false;
+    state.boardKey = computeBoardKey(state);
+    state.hash = computeHash(state);
+}
+
+void initializeGame(GameState &state,
+                    const std::vector<int> &valuesVec,
+                    const std::vector<int> &weightsVec)
+{
+    fillBoard(state, valuesVec, weightsVec);
+    startGame(state);
+}
+
+// one seed per process and a shared game number, so no two calls deal the same stream
+void initializeRandomGame(GameState &state)
+{
+    static const uint64_t processSeed = randomSeed();
+    static std::atomic<uint64_t> nextGame(0);
+
+    initializeSeededGame(state, processSeed, nextGame.fetch_add(1, std::memory_order_relaxed));
+}
+
+void initializeSeededGame(GameState &state, uint64_t seed, uint64_t gameIndex)
+{
+    CounterRng rng(seed, gameIndex);
+    initializeDealtGame(state, rng);
+}
+
+void initializeDealtGame(GameState &state, CounterRng &rng)
+{
+    dealBoard(state, rng);
+    startGame(state);
+}
+
+static void placePiece(GameState &state, int player, int square)
+{
+    PieceState &piece = state.pieces[player];
+
+    state.hash ^= pieceKey(player, piece) ^ VISITED_KEYS[square];
+
+    piece.currentWeight += tileWeight(state, square);
+    piece.score += tileValue(state, square);
+    piece.square = (uint8_t)square;
+    state.visited |= squareBit(square);
+    state.occupancy[player] |= squareBit(square);
+
+    state.hash ^= pieceKey(player, piece);
+}
+
+void deactivatePiece(GameState &state, int player)
+{
+    state.activeMask &= ~(1 << player);
+    state.hash ^= ACTIVE_KEYS[player];
+}
+
+bool movePiece(GameState &state, int square)
+{
+    int player = state.piecesIndex;
+
+    if (state.isGameOver || !isActive(state, player) || !isLegalMove(state, player, square))
+        return false;
+
+    placePiece(state, player, square);
+
+    return true;
+}
+
+// moves the current player's piece and hands the turn to the next player
+bool applyMove(GameState &state, int square)
+{
+    if (!movePiece(state, square))
+        return false;
+
+    if (checkRemainingMoves(state, state.piecesIndex) == 0)
+        deactivatePiece(state, state.piecesIndex);
+
+    finishTurn(state);
+    return true;
+}
+
+// applyMove without the legality check, for search and playouts
+void playMove(GameState &state, int square)
+{
+    int player = state.piecesIndex;
+
+    placePiece(state, player, square);
+
+    if (getLegalMoves(state, player) == 0)
+        deactivatePiece(state, player);
+
+    finishTurn(state);
+}
+
+// playMove that records what it changes on the stack
+void makeMove(GameState &state, int square, MoveStack &stack)
+{
+    int player = state.piecesIndex;
+    PieceState &piece = state.pieces[player];
+    UndoEntry &entry = stack.entries[stack.size++];
+
+    entry.square = (uint8_t)square;
+    entry.prevSquare = piece.square;
+    entry.prevWeight = piece.currentWeight;
+    entry.prevScore = piece.score;
+    entry.prevActiveMask = state.activeMask;
+    entry.prevWinnerMask = state.winnerMask;
+    entry.prevPiecesIndex = state.piecesIndex;
+    entry.prevGameOver = state.isGameOver;
+    entry.prevTie = state.isTie;
+    entry.prevHash = state.hash;
+
+    playMove(state, square);
+}
+
+void unmakeMove(GameState &state, MoveStack &stack)
+{
+    const UndoEntry &entry = stack.entries[--stack.size];
+    int player = entry.prevPiecesIndex;
+    PieceState &piece = state.pieces[player];
+
+    piece.square = entry.prevSquare;
+    piece.currentWeight = entry.prevWeight;
+    piece.score = entry.prevScore;
+    state.visited &= ~squareBit(entry.square);
+    state.occupancy[player] &= ~squareBit(entry.square);
+    state.activeMask = entry.prevActiveMask;
+    state.winnerMask = entry.prevWinnerMask;
+    state.piecesIndex = entry.prevPiecesIndex;
+    state.isGameOver = entry.prevGameOver;
+    state.isTie = entry.prevTie;
+    state.hash = entry.prevHash;
+}
+
+void finishTurn(GameState &state)
+{
+    while (true)
+    {
+        state.isGameOver = checkGameOver(state);
+
+        if (state.isGameOver)
+        {
+            setWinner(state);
+            int winnerCount = countWinner(state);
+
+            if (winnerCount > 1)
+                state.isTie = true;
+
+            return;
+        }
+
+        state.hash ^= PLAYER_TO_MOVE_KEYS[state.piecesIndex];
+
+        do
+        {
+            state.piecesIndex = (state.piecesIndex + 1) % NUM_PLAYERS;
+
+        } while (!isActive(state, state.piecesIndex));
+
+        state.hash ^= PLAYER_TO_MOVE_KEYS[state.piecesIndex];
+
+        // a piece that has been boxed in by the other players drops out here,
+        // so the player to move always has at least one legal move
+        if (checkRemainingMoves(state, state.piecesIndex) > 0)
+            return;
+
+        deactivatePiece(state, state.piecesIndex);
+    }
+}
+
+bool checkGameOver(const GameState &state)
+{
+    return state.activeMask == 0;
+}
+
+void setWinner(GameState &state)
+{
+    int maxValue = state.pieces[0].score;
+
+    for (const PieceState &p : state.pieces)
+        maxValue = std::max(maxValue, (int)p.score);
+
+    int minWeight = MAX_WEIGHT;
+
+    for (const PieceState &p : state.pieces)
+    {
+        if (p.score == maxValue)
+            minWeight = std::min(minWeight, (int)p.currentWeight);
+    }
+
+    state.winnerMask = 0;
+
+    for (int player = 0; player < NUM_PLAYERS; player++)
+    {
+        const PieceState &p = state.pieces[player];
+
+        if (p.score == maxValue && p.currentWeight == minWeight)
+            state.winnerMask |= 1 << player;
+    }
+}
+
+int countWinner(const GameState &state)
+{
+    return popCount(state.winnerMask);
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+const int BOARD_SIZE = 8;
+const int NUM_SQUARES = BOARD_SIZE * BOARD_SIZE;
+const int NUM_PLAYERS = 4;
+const int MAX_WEIGHT = 24;
+const int MAX_TILE_WEIGHT = 4;
+const int NUM_TILES = NUM_SQUARES - NUM_PLAYERS; // every square but the starts holds a tile
+
+// tiles store the value offset by VALUE_BIAS in the low nibble and the weight in the high nibble
+const int VALUE_BIAS = 4;
+
+static_assert(NUM_SQUARES <= 64, "the board must fit in a 64-bit mask");
+
+struct CounterRng;
+
+extern const std::vector<int> TILE_VALUES;
+extern const std::vector<int> TILE_WEIGHTS;
+
+// the squares that hold tiles in board order, the order boards are dealt and packed in
+extern const std::array<uint8_t, NUM_TILES> TILE_SQUARES;
+
+struct PieceState
+{
+    uint8_t square;
+    uint8_t currentWeight;
+    int16_t score;
+};
+
+// the rules-only state of one game, free of any rendering data
+struct alignas(64) GameState
+{
+    std::array<uint8_t, NUM_SQUARES> tiles;
+    uint64_t visited;
+    std::array<uint64_t, NUM_PLAYERS> occupancy; // squares taken by each player
+    std::array<uint64_t, MAX_TILE_WEIGHT + 1> weightMasks; // squares of weight <= k, built once per board
+    std::array<PieceState, NUM_PLAYERS> pieces;
+    uint8_t activeMask;
+    uint8_t winnerMask;
+    uint8_t piecesIndex;
+    bool isGameOver;
+    bool isTie;
+    uint64_t boardKey; // hash of the tiles, fixed for the whole game
+    uint64_t hash;     // zobrist hash of the position, see zobrist.h
+};
+
+// everything makeMove overwrites, so unmakeMove can restore the state in place
+struct UndoEntry
+{
+    uint8_t square;
+    uint8_t prevSquare;
+    uint8_t prevWeight;
+    uint8_t prevActiveMask;
+    uint8_t prevWinnerMask;
+    uint8_t prevPiecesIndex;
+    bool prevGameOver;
+    bool prevTie;
+    int16_t prevScore;
+    uint64_t prevHash;
+};
+
+// a game never lasts more moves than there are squares, so the stack never allocates
+struct MoveStack
+{
+    std::array<UndoEntry, NUM_SQUARES> entries;
+    int size = 0;
+};
+
+static_assert(std::is_trivially_copyable<GameState>::value, "GameState must copy as plain memory");
+static_assert(sizeof(GameState) <= 192, "GameState should fit in three cache lines");
+
+inline int squareIndex(int row, int col) { return row * BOARD_SIZE + col; }
+inline int squareRow(int square) { return square / BOARD_SIZE; }
+inline int squareCol(int square) { return square % BOARD_SIZE; }
+inline uint64_t squareBit(int square) { return uint64_t(1) << square; }
+
+inline int tileValue(const GameState &state, int square) { return (state.tiles[square] & 0xF) - VALUE_BIAS; }
+inline int tileWeight(const GameState &state, int square) { return state.tiles[square] >> 4; }
+
+inline bool isActive(const GameState &state, int player) { return state.activeMask & (1 << player); }
+inline bool isWinner(const GameState &state, int player) { return state.winnerMask & (1 << player); }
+
+// returns the player who took the square, -1 for untaken and start squares
+int squareOwner(const GameState &state, int square);
+
+bool isStartSquare(int row, int col);
+
+std::vector<int> createIntVector(const std::vector<int> &vector, int numOfInstances);
+void randomizeVector(std::vector<int> &vector, CounterRng &rng);
+void fillBoard(GameState &state, const std::vector<int> &valuesVec, const std::vector<int> &weightsVec);
+void initializeGame(GameState &state, const std::vector<int> &valuesVec, const std::vector<int> &weightsVec);
+void initializeRandomGame(GameState &state);
+
+// puts tiles[i] on TILE_SQUARES[i], clears the start squares and rebuilds the weight masks
+void setBoardTiles(GameState &state, const std::array<uint8_t, NUM_TILES> &tiles);
+
+// a uniformly shuffled board written straight into state's tiles and masks, no heap allocation
+void dealBoard(GameState &state, CounterRng &rng);
+
+// the starting pieces, turn and hashes for the board already in state
+void startGame(GameState &state);
+
+// dealBoard and the starting pieces, for callers that deal several boards from one stream
+void initializeDealtGame(GameState &state, CounterRng &rng);
+
+// board gameIndex of seed's run, the same on every machine, so runs can be repeated,
+// split across threads and any one board regenerated on its own
+void initializeSeededGame(GameState &state, uint64_t seed, uint64_t gameIndex = 0);
+
+bool movePiece(GameState &state, int square);
+void deactivatePiece(GameState &state, int player);
+bool applyMove(GameState &state, int square);
+void playMove(GameState &state, int square);
+void makeMove(GameState &state, int square, MoveStack &stack);
+void unmakeMove(GameState &state, MoveStack &stack);
+void finishTurn(GameState &state);
+bool checkGameOver(const GameState &state);
+void setWinner(GameState &state);
+int countWinner(const GameState &state);
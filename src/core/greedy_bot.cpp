@@ -0,0 +1,52 @@
+#include "greedy_bot.h"
+#include "move_gen.h"
+
+// takes the highest-value neighbor, preferring the lowest weight on ties
+int getBestMove(const GameState &state, uint64_t legalMoves)
+{
+    int maxValue = -10;
+    int minWeight = 5;
+    int bestMove = -1;
+
+    while (legalMoves)
+    {
+        int square = popLowestSquare(legalMoves);
+        int boardValue = tileValue(state, square);
+        int boardWeight = tileWeight(state, square);
+
+        if (boardValue == maxValue && boardWeight <= minWeight)
+        {
+            minWeight = boardWeight;
+            bestMove = square;
+        }
+        else if (boardValue > maxValue)
+        {
+            maxValue = boardValue;
+            minWeight = boardWeight;
+            bestMove = square;
+        }
+    }
+
+    return bestMove;
+}
+
+void makeCPUMove(GameState &state)
+{
+    uint64_t legalMoves = getLegalMoves(state, state.piecesIndex);
+
+    if (legalMoves == 0)
+    {
+        deactivatePiece(state, state.piecesIndex);
+        finishTurn(state);
+        return;
+    }
+
+    applyMove(state, getBestMove(state, legalMoves));
+}
+
+// plays every seat greedily until the game is over
+void playGreedyGame(GameState &state)
+{
+    while (!state.isGameOver)
+        makeCPUMove(state);
+}
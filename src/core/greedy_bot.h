@@ -0,0 +1,9 @@
+#pragma once
+
+#include "game_state.h"
+
+#include <cstdint>
+
+int getBestMove(const GameState &state, uint64_t legalMoves);
+void makeCPUMove(GameState &state);
+void playGreedyGame(GameState &state);
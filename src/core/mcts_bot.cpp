@@ -0,0 +1,394 @@
+#include "mcts_bot.h"
+#include "greedy_bot.h"
+#include "move_gen.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+// game results are win shares of 1, 1/2, 1/3 or 1/4, kept exactly in a multiple of
+// twelfths that is also fine enough for network values
+const uint64_t REWARD_UNITS = 12 * 256;
+
+enum NodeState : uint8_t
+{
+    NODE_LEAF,
+    NODE_EXPANDING,
+    NODE_EXPANDED
+};
+
+// shared by every search thread. No default member initializers, so the arena
+// can hand out nodes without touching memory it never uses.
+struct MctsNode
+{
+    std::atomic<uint32_t> visits; // includes the virtual losses of playouts in flight
+    std::atomic<uint64_t> reward; // sum of the mover's win shares, in REWARD_UNITS
+    std::atomic<uint8_t> expansion;
+    int32_t firstChild;
+    uint8_t childCount;
+    uint8_t move;  // square moved to from the parent
+    uint8_t mover; // player who made that move
+};
+
+// fixed block of nodes handed out with one atomic bump, never freed during a search
+class MctsArena
+{
+public:
+    explicit MctsArena(size_t capacity)
+        : nodes(new MctsNode[capacity]), capacity(capacity), used(0) {}
+
+    // index of the first of count fresh nodes, -1 once the arena is full
+    int allocate(int count)
+    {
+        size_t first = used.fetch_add(count, std::memory_order_relaxed);
+
+        if (first + count > capacity)
+            return -1;
+
+        for (size_t i = first; i < first + count; i++)
+        {
+            nodes[i].visits.store(0, std::memory_order_relaxed);
+            nodes[i].reward.store(0, std::memory_order_relaxed);
+            nodes[i].expansion.store(NODE_LEAF, std::memory_order_relaxed);
+            nodes[i].firstChild = -1;
+            nodes[i].childCount = 0;
+        }
+
+        return (int)first;
+    }
+
+    MctsNode &operator[](int index) { return nodes[index]; }
+    const MctsNode &operator[](int index) const { return nodes[index]; }
+
+private:
+    std::unique_ptr<MctsNode[]> nodes;
+    size_t capacity;
+    std::atomic<size_t> used;
+};
+
+struct MctsShared
+{
+    const GameState *root;
+    const MctsConfig *config;
+    MctsArena arena;
+    std::chrono::steady_clock::time_point deadline;
+    std::atomic<int64_t> playouts;
+    std::atomic<bool> stop;
+
+    explicit MctsShared(size_t capacity) : arena(capacity), playouts(0), stop(false) {}
+};
+
+static int randomMove(uint64_t legalMoves, std::mt19937_64 &rng)
+{
+    int skip = (int)(rng() % (uint64_t)popCount(legalMoves));
+
+    for (int i = 0; i < skip; i++)
+        legalMoves &= legalMoves - 1;
+
+    return lowestSquare(legalMoves);
+}
+
+static void rollout(GameState &state, RolloutPolicy policy, std::mt19937_64 &rng)
+{
+    while (!state.isGameOver)
+    {
+        uint64_t legalMoves = getLegalMoves(state, state.piecesIndex);
+        int move = policy == RolloutPolicy::Greedy ? getBestMove(state, legalMoves) : randomMove(legalMoves, rng);
+        playMove(state, move);
+    }
+}
+
+// only the thread that wins the leaf -> expanding swap builds the children,
+// the others roll out from the leaf until the children are published
+static bool tryExpand(MctsArena &arena, int index, const GameState &state)
+{
+    MctsNode &node = arena[index];
+    uint8_t expected = NODE_LEAF;
+
+    if (!node.expansion.compare_exchange_strong(expected, NODE_EXPANDING, std::memory_order_acq_rel))
+        return false;
+
+    uint64_t legalMoves = getLegalMoves(state, state.piecesIndex);
+    int firstChild = arena.allocate(popCount(legalMoves));
+
+    if (firstChild < 0)
+    {
+        node.expansion.store(NODE_LEAF, std::memory_order_release);
+        return false;
+    }
+
+    int childCount = 0;
+
+    while (legalMoves)
+    {
+        MctsNode &child = arena[firstChild + childCount++];
+        child.move = (uint8_t)popLowestSquare(legalMoves);
+        child.mover = state.piecesIndex;
+    }
+
+    node.firstChild = firstChild;
+    node.childCount = (uint8_t)childCount;
+    node.expansion.store(NODE_EXPANDED, std::memory_order_release);
+    return true;
+}
+
+// UCT from the point of view of the player to move at the node, unvisited children first
+static int selectChild(const MctsArena &arena, int index, double exploration)
+{
+    const MctsNode &node = arena[index];
+    double logVisits = std::log((double)std::max<uint32_t>(node.visits.load(std::memory_order_relaxed), 1));
+    double bestScore = -1.0;
+    int bestChild = node.firstChild;
+
+    for (int i = node.firstChild; i < node.firstChild + node.childCount; i++)
+    {
+        const MctsNode &child = arena[i];
+        uint32_t visits = child.visits.load(std::memory_order_relaxed);
+
+        if (visits == 0)
+            return i;
+
+        double meanReward = (double)child.reward.load(std::memory_order_relaxed) / (REWARD_UNITS * visits);
+        double score = meanReward + exploration * std::sqrt(logVisits / visits);
+
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestChild = i;
+        }
+    }
+
+    return bestChild;
+}
+
+// walks from the root to a leaf, expanding it if it can, with virtual loss on every node passed
+static int selectLeaf(MctsShared &shared, GameState &playout, std::array<int, NUM_SQUARES + 1> &path, uint32_t virtualLoss)
+{
+    MctsArena &arena = shared.arena;
+    int index = 0;
+    int length = 0;
+
+    // each node on the path counts as already visited and lost until the playout returns
+    arena[0].visits.fetch_add(virtualLoss, std::memory_order_relaxed);
+    path[length++] = 0;
+
+    while (!playout.isGameOver &&
+           arena[index].expansion.load(std::memory_order_acquire) == NODE_EXPANDED)
+    {
+        index = selectChild(arena, index, shared.config->exploration);
+        arena[index].visits.fetch_add(virtualLoss, std::memory_order_relaxed);
+        playMove(playout, arena[index].move);
+        path[length++] = index;
+    }
+
+    if (!playout.isGameOver && tryExpand(arena, index, playout))
+    {
+        index = arena[index].firstChild;
+        arena[index].visits.fetch_add(virtualLoss, std::memory_order_relaxed);
+        playMove(playout, arena[index].move);
+        path[length++] = index;
+    }
+
+    return length;
+}
+
+// credits every node on the path with its mover's reward and takes back the extra virtual loss
+static void backUp(MctsArena &arena, const int *path, int length, const std::array<uint64_t, NUM_PLAYERS> &rewards,
+                   uint32_t virtualLoss)
+{
+    for (int i = 0; i < length; i++)
+    {
+        MctsNode &node = arena[path[i]];
+
+        if (virtualLoss > 1)
+            node.visits.fetch_sub(virtualLoss - 1, std::memory_order_relaxed);
+
+        node.reward.fetch_add(rewards[node.mover], std::memory_order_relaxed);
+    }
+}
+
+static std::array<uint64_t, NUM_PLAYERS> gameRewards(const GameState &state)
+{
+    std::array<uint64_t, NUM_PLAYERS> rewards = {};
+    uint64_t share = REWARD_UNITS / countWinner(state);
+
+    for (int player = 0; player < NUM_PLAYERS; player++)
+        rewards[player] = isWinner(state, player) ? share : 0;
+
+    return rewards;
+}
+
+static bool shouldStop(MctsShared &shared, int64_t &count)
+{
+    const MctsConfig &config = *shared.config;
+
+    if (shared.stop.load(std::memory_order_relaxed))
+        return true;
+
+    if ((count++ & 15) == 0 &&
+        (std::chrono::steady_clock::now() >= shared.deadline ||
+         (config.stop && config.stop->load(std::memory_order_relaxed))))
+        return true;
+
+    return config.maxPlayouts > 0 &&
+           shared.playouts.fetch_add(1, std::memory_order_relaxed) >= config.maxPlayouts;
+}
+
+static void runPlayouts(MctsShared &shared, int thread)
+{
+    const MctsConfig &config = *shared.config;
+    MctsArena &arena = shared.arena;
+    std::mt19937_64 rng(config.seed + (uint64_t)thread * 0x9E3779B97F4A7C15ULL);
+    std::array<int, NUM_SQUARES + 1> path;
+    uint32_t virtualLoss = (uint32_t)std::max(config.virtualLoss, 1);
+    int64_t count = 0;
+
+    while (!shouldStop(shared, count))
+    {
+        GameState playout = *shared.root;
+        int length = selectLeaf(shared, playout, path, virtualLoss);
+
+        rollout(playout, config.rolloutPolicy, rng);
+        backUp(arena, path.data(), length, gameRewards(playout), virtualLoss);
+
+        if (config.maxPlayouts == 0)
+            shared.playouts.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// network leaves in batches: finished games are scored at once, the rest wait for one
+// evaluateNetworkBatch call, their paths held apart by virtual loss meanwhile
+static void runNetworkPlayouts(MctsShared &shared)
+{
+    const MctsConfig &config = *shared.config;
+    MctsArena &arena = shared.arena;
+    int batchSize = std::min(std::max(config.networkBatch, 1), NET_MAX_BATCH);
+    uint32_t virtualLoss = (uint32_t)std::max(config.virtualLoss, 1);
+    std::vector<GameState> leaves(batchSize);
+    std::vector<const GameState *> pending(batchSize);
+    std::vector<std::array<int, NUM_SQUARES + 1>> paths(batchSize);
+    std::vector<int> lengths(batchSize);
+    std::vector<NetworkOutput> outputs(batchSize);
+    int64_t count = 0;
+    bool stopping = false;
+
+    while (!stopping)
+    {
+        int collected = 0;
+        int playouts = 0;
+
+        while (collected < batchSize && !(stopping = shouldStop(shared, count)))
+        {
+            GameState &leaf = leaves[collected];
+            leaf = *shared.root;
+            lengths[collected] = selectLeaf(shared, leaf, paths[collected], virtualLoss);
+            playouts++;
+
+            if (leaf.isGameOver)
+            {
+                backUp(arena, paths[collected].data(), lengths[collected], gameRewards(leaf), virtualLoss);
+                continue;
+            }
+
+            pending[collected] = &leaf;
+            collected++;
+        }
+
+        evaluateNetworkBatch(*config.network, pending.data(), collected, outputs.data());
+
+        for (int i = 0; i < collected; i++)
+        {
+            std::array<uint64_t, NUM_PLAYERS> rewards;
+
+            for (int player = 0; player < NUM_PLAYERS; player++)
+                rewards[player] = (uint64_t)std::lround(outputs[i].winShares[player] * REWARD_UNITS);
+
+            backUp(arena, paths[i].data(), lengths[i], rewards, virtualLoss);
+        }
+
+        if (config.maxPlayouts == 0)
+            shared.playouts.fetch_add(playouts, std::memory_order_relaxed);
+    }
+}
+
+static void runThread(MctsShared &shared, int thread)
+{
+    if (shared.config->network)
+        runNetworkPlayouts(shared);
+    else
+        runPlayouts(shared, thread);
+}
+
+MctsResult searchMcts(const GameState &state, const MctsConfig &config)
+{
+    MctsResult result;
+
+    if (state.isGameOver)
+        return result;
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    // the root and all of its children always fit, whatever the node budget
+    MctsShared shared(std::max(config.maxNodes, (size_t)(1 + NUM_SQUARES)));
+    shared.root = &state;
+    shared.config = &config;
+    shared.deadline = startTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                      std::chrono::duration<double>(config.timeBudget));
+
+    MctsArena &arena = shared.arena;
+    arena.allocate(1);
+    arena[0].move = 0;
+    arena[0].mover = state.piecesIndex;
+    tryExpand(arena, 0, state);
+
+    if (arena[0].childCount > 1)
+    {
+        std::vector<std::thread> helpers;
+
+        for (int thread = 1; thread < config.threads; thread++)
+            helpers.emplace_back(runThread, std::ref(shared), thread);
+
+        runThread(shared, 0);
+        shared.stop.store(true, std::memory_order_relaxed);
+
+        for (std::thread &helper : helpers)
+            helper.join();
+    }
+
+    const MctsNode &root = arena[0];
+    uint32_t mostVisits = 0;
+
+    result.playouts = shared.playouts.load();
+
+    // with a playout cap every thread counts one extra playout on its way out
+    if (config.maxPlayouts > 0)
+        result.playouts = std::min(result.playouts, config.maxPlayouts);
+
+    result.bestMove = arena[root.firstChild].move;
+    result.childCount = root.childCount;
+
+    for (int i = 0; i < root.childCount; i++)
+    {
+        const MctsNode &child = arena[root.firstChild + i];
+        uint32_t visits = child.visits.load();
+
+        result.childMoves[i] = child.move;
+        result.childVisits[i] = visits;
+
+        if (visits > mostVisits)
+        {
+            mostVisits = visits;
+            result.bestMove = child.move;
+        }
+    }
+
+    result.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    result.playoutsPerSecond = result.elapsed > 0.0 ? result.playouts / result.elapsed : 0.0;
+    return result;
+}
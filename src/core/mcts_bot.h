@@ -0,0 +1,51 @@
+#pragma once
+
+#include "game_state.h"
+#include "network_eval.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+enum class RolloutPolicy
+{
+    Random,
+    Greedy // getBestMove for every seat
+};
+
+struct MctsConfig
+{
+    double exploration = 0.7; // UCT constant, rewards are win shares in [0, 1]
+    double timeBudget = 0.5;  // seconds
+    int64_t maxPlayouts = 0;  // 0 for no limit
+    RolloutPolicy rolloutPolicy = RolloutPolicy::Random;
+    uint64_t seed = 1;
+    const std::atomic<bool> *stop = nullptr; // optional, ends the search early when set
+
+    // tree-parallel search: every thread walks the same tree, virtualLoss visits
+    // per node steer concurrent playouts apart until their results come back
+    int threads = 1;
+    int virtualLoss = 1;
+    size_t maxNodes = 1 << 20; // arena capacity, expansion stops when it runs out
+
+    // optional, leaves are scored by the network's value head instead of a rollout.
+    // Each thread collects networkBatch leaves under virtual loss and evaluates them together.
+    const Network *network = nullptr;
+    int networkBatch = 8;
+};
+
+struct MctsResult
+{
+    int bestMove = -1;
+    int64_t playouts = 0;
+    double elapsed = 0.0; // seconds
+    double playoutsPerSecond = 0.0;
+
+    // visit counts of the root's children, the most visited one is bestMove
+    int childCount = 0;
+    std::array<uint8_t, 8> childMoves;
+    std::array<int64_t, 8> childVisits;
+};
+
+MctsResult searchMcts(const GameState &state, const MctsConfig &config);
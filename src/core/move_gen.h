@@ -0,0 +1,120 @@
+#pragma once
+
+#include "bitboard.h"
+#include "game_state.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+struct NeighborList
+{
+    uint8_t count;
+    std::array<uint8_t, 8> squares;
+};
+
+constexpr std::array<uint64_t, NUM_SQUARES> makeKingMoves()
+{
+    std::array<uint64_t, NUM_SQUARES> moves = {};
+
+    for (int square = 0; square < NUM_SQUARES; square++)
+    {
+        int row = square / BOARD_SIZE;
+        int col = square % BOARD_SIZE;
+
+        for (int dr = -1; dr <= 1; dr++)
+        {
+            for (int dc = -1; dc <= 1; dc++)
+            {
+                int destRow = row + dr;
+                int destCol = col + dc;
+
+                if ((dr != 0 || dc != 0) &&
+                    destRow >= 0 && destRow < BOARD_SIZE &&
+                    destCol >= 0 && destCol < BOARD_SIZE)
+                    moves[square] |= uint64_t(1) << (destRow * BOARD_SIZE + destCol);
+            }
+        }
+    }
+
+    return moves;
+}
+
+constexpr std::array<NeighborList, NUM_SQUARES> makeNeighborLists()
+{
+    std::array<uint64_t, NUM_SQUARES> moves = makeKingMoves();
+    std::array<NeighborList, NUM_SQUARES> lists = {};
+
+    for (int square = 0; square < NUM_SQUARES; square++)
+    {
+        for (int dest = 0; dest < NUM_SQUARES; dest++)
+        {
+            if (moves[square] & (uint64_t(1) << dest))
+                lists[square].squares[lists[square].count++] = (uint8_t)dest;
+        }
+    }
+
+    return lists;
+}
+
+// every square a piece can step to from each square, bounds already applied
+constexpr std::array<uint64_t, NUM_SQUARES> KING_MOVES = makeKingMoves();
+constexpr std::array<NeighborList, NUM_SQUARES> NEIGHBOR_LISTS = makeNeighborLists();
+
+constexpr uint64_t makeColumnMask(int col)
+{
+    uint64_t mask = 0;
+
+    for (int row = 0; row < BOARD_SIZE; row++)
+        mask |= uint64_t(1) << (row * BOARD_SIZE + col);
+
+    return mask;
+}
+
+constexpr uint64_t BOARD_MASK = NUM_SQUARES == 64 ? ~uint64_t(0) : (uint64_t(1) << NUM_SQUARES) - 1;
+constexpr uint64_t FIRST_COLUMN = makeColumnMask(0);
+constexpr uint64_t LAST_COLUMN = makeColumnMask(BOARD_SIZE - 1);
+
+// every square one king step from the mask, plus the mask itself
+inline uint64_t kingDilate(uint64_t mask)
+{
+    uint64_t row = mask | ((mask << 1) & ~FIRST_COLUMN) | ((mask >> 1) & ~LAST_COLUMN);
+    return (row | (row << BOARD_SIZE) | (row >> BOARD_SIZE)) & BOARD_MASK;
+}
+
+// the open squares connected to the seeds by king steps through open squares, seeds excluded
+inline uint64_t floodFill(uint64_t seeds, uint64_t open)
+{
+    uint64_t reached = 0;
+    uint64_t frontier = kingDilate(seeds) & open;
+
+    while (frontier)
+    {
+        reached |= frontier;
+        frontier = kingDilate(frontier) & open & ~reached;
+    }
+
+    return reached;
+}
+
+// squares whose weight still fits under the piece's capacity
+inline uint64_t weightFeasibleMask(const GameState &state, int player)
+{
+    int remaining = MAX_WEIGHT - state.pieces[player].currentWeight;
+    return state.weightMasks[std::min(remaining, MAX_TILE_WEIGHT)];
+}
+
+inline uint64_t getLegalMoves(const GameState &state, int player)
+{
+    return KING_MOVES[state.pieces[player].square] & ~state.visited & weightFeasibleMask(state, player);
+}
+
+inline bool isLegalMove(const GameState &state, int player, int square)
+{
+    return square >= 0 && square < NUM_SQUARES && (getLegalMoves(state, player) & squareBit(square));
+}
+
+inline int checkRemainingMoves(const GameState &state, int player)
+{
+    return popCount(getLegalMoves(state, player));
+}
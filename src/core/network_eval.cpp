@@ -0,0 +1,311 @@
+#include "network_eval.h"
+#include "cpu_features.h"
+#include "zobrist.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+const char NETWORK_MAGIC[4] = {'T', 'T', 'N', 'N'};
+const uint32_t NETWORK_VERSION = 1;
+
+// the highest activation and input byte, so u8 x s8 pair sums never saturate 16 bits
+const int NET_ACTIVATION_MAX = 127;
+
+void initializeRandomNetwork(Network &network, uint64_t seed)
+{
+    uint64_t counter = seed;
+
+    // uniform in [-range, range], from the same mixer as the zobrist keys
+    auto randomWeight = [&counter](int range)
+    {
+        return (int8_t)((int)(splitMix64(counter++) % (uint64_t)(2 * range + 1)) - range);
+    };
+
+    network.hiddenWeights.resize(NET_HIDDEN * NET_INPUTS);
+    network.hiddenBias.assign(NET_HIDDEN, 0);
+    network.valueWeights.resize(NUM_PLAYERS * NET_HIDDEN);
+    network.valueBias.assign(NUM_PLAYERS, 0);
+    network.policyWeights.resize(NUM_SQUARES * NET_HIDDEN);
+    network.policyBias.assign(NUM_SQUARES, 0);
+
+    for (int8_t &weight : network.hiddenWeights)
+        weight = randomWeight(4);
+
+    for (int8_t &weight : network.valueWeights)
+        weight = randomWeight(16);
+
+    for (int8_t &weight : network.policyWeights)
+        weight = randomWeight(16);
+
+    // keeps the untrained outputs near uniform
+    network.valueScale = 1.0f / 4096;
+    network.policyScale = 1.0f / 4096;
+}
+
+template <typename T>
+static bool readArray(std::ifstream &file, std::vector<T> &values, size_t count)
+{
+    values.resize(count);
+    return (bool)file.read((char *)values.data(), count * sizeof(T));
+}
+
+template <typename T>
+static void writeArray(std::ofstream &file, const std::vector<T> &values)
+{
+    file.write((const char *)values.data(), values.size() * sizeof(T));
+}
+
+// little-endian layout: magic, version, input and hidden sizes, then the arrays in struct order
+bool loadNetwork(const std::string &path, Network &network)
+{
+    std::ifstream file(path, std::ios::binary);
+    char magic[4];
+    uint32_t header[3];
+
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, NETWORK_MAGIC, sizeof(magic)) != 0)
+        return false;
+
+    if (!file.read((char *)header, sizeof(header)) ||
+        header[0] != NETWORK_VERSION || header[1] != NET_INPUTS || header[2] != NET_HIDDEN)
+        return false;
+
+    return readArray(file, network.hiddenWeights, NET_HIDDEN * NET_INPUTS) &&
+           readArray(file, network.hiddenBias, NET_HIDDEN) &&
+           readArray(file, network.valueWeights, NUM_PLAYERS * NET_HIDDEN) &&
+           readArray(file, network.valueBias, NUM_PLAYERS) &&
+           readArray(file, network.policyWeights, NUM_SQUARES * NET_HIDDEN) &&
+           readArray(file, network.policyBias, NUM_SQUARES) &&
+           file.read((char *)&network.valueScale, sizeof(float)) &&
+           file.read((char *)&network.policyScale, sizeof(float));
+}
+
+bool saveNetwork(const std::string &path, const Network &network)
+{
+    std::ofstream file(path, std::ios::binary);
+    uint32_t header[3] = {NETWORK_VERSION, NET_INPUTS, NET_HIDDEN};
+
+    file.write(NETWORK_MAGIC, sizeof(NETWORK_MAGIC));
+    file.write((const char *)header, sizeof(header));
+    writeArray(file, network.hiddenWeights);
+    writeArray(file, network.hiddenBias);
+    writeArray(file, network.valueWeights);
+    writeArray(file, network.valueBias);
+    writeArray(file, network.policyWeights);
+    writeArray(file, network.policyBias);
+    file.write((const char *)&network.valueScale, sizeof(float));
+    file.write((const char *)&network.policyScale, sizeof(float));
+
+    return (bool)file;
+}
+
+// players are numbered in turn order from the mover, so one set of weights serves every seat
+void writeNetworkInputs(const GameState &state, uint8_t *inputs)
+{
+    std::memset(inputs, 0, NET_INPUTS);
+
+    for (int square = 0; square < NUM_SQUARES; square++)
+    {
+        if (state.visited & squareBit(square))
+        {
+            inputs[square] = NET_ACTIVATION_MAX;
+            continue;
+        }
+
+        inputs[NUM_SQUARES + square] = (uint8_t)((tileValue(state, square) + VALUE_BIAS) * 10);
+        inputs[2 * NUM_SQUARES + square] = (uint8_t)(tileWeight(state, square) * 30);
+    }
+
+    uint8_t *playerFeatures = inputs + NET_PLANES * NUM_SQUARES;
+
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        int player = (state.piecesIndex + i) % NUM_PLAYERS;
+        const PieceState &piece = state.pieces[player];
+
+        if (isActive(state, player))
+            inputs[(3 + i) * NUM_SQUARES + piece.square] = NET_ACTIVATION_MAX;
+
+        playerFeatures[i * NET_PLAYER_FEATURES] = (uint8_t)((MAX_WEIGHT - piece.currentWeight) * 5);
+        playerFeatures[i * NET_PLAYER_FEATURES + 1] = isActive(state, player) ? NET_ACTIVATION_MAX : 0;
+        playerFeatures[i * NET_PLAYER_FEATURES + 2] = (uint8_t)std::min(std::max(piece.score + 32, 0), NET_ACTIVATION_MAX);
+    }
+}
+
+static int32_t dotScalar(const uint8_t *inputs, const int8_t *weights, int size)
+{
+    int32_t sum = 0;
+
+    for (int i = 0; i < size; i++)
+        sum += inputs[i] * weights[i];
+
+    return sum;
+}
+
+#ifdef CORE_HAS_AVX2
+
+AVX2_TARGET static inline int32_t sumLanes(__m256i sum)
+{
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(half);
+}
+
+// 32 byte products per step, pairs summed to 16 bits by maddubs and then to 32 bits by madd
+AVX2_TARGET static int32_t dotAvx2(const uint8_t *inputs, const int8_t *weights, int size)
+{
+    __m256i sum = _mm256_setzero_si256();
+    __m256i ones = _mm256_set1_epi16(1);
+
+    for (int i = 0; i < size; i += 32)
+    {
+        __m256i products = _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i *)(inputs + i)),
+                                                _mm256_loadu_si256((const __m256i *)(weights + i)));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(products, ones));
+    }
+
+    return sumLanes(sum);
+}
+
+// one weight row against four inputs, each block of weights is loaded once for all four
+AVX2_TARGET static void dot4Avx2(const uint8_t *const *inputs, const int8_t *weights, int size, int32_t *sums)
+{
+    __m256i sum0 = _mm256_setzero_si256();
+    __m256i sum1 = _mm256_setzero_si256();
+    __m256i sum2 = _mm256_setzero_si256();
+    __m256i sum3 = _mm256_setzero_si256();
+    __m256i ones = _mm256_set1_epi16(1);
+
+    for (int i = 0; i < size; i += 32)
+    {
+        __m256i w = _mm256_loadu_si256((const __m256i *)(weights + i));
+
+        sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(_mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i *)(inputs[0] + i)), w), ones));
+        sum1 = _mm256_add_epi32(sum1, _mm256_madd_epi16(_mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i *)(inputs[1] + i)), w), ones));
+        sum2 = _mm256_add_epi32(sum2, _mm256_madd_epi16(_mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i *)(inputs[2] + i)), w), ones));
+        sum3 = _mm256_add_epi32(sum3, _mm256_madd_epi16(_mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i *)(inputs[3] + i)), w), ones));
+    }
+
+    sums[0] = sumLanes(sum0);
+    sums[1] = sumLanes(sum1);
+    sums[2] = sumLanes(sum2);
+    sums[3] = sumLanes(sum3);
+}
+
+#endif
+
+static void dot4Scalar(const uint8_t *const *inputs, const int8_t *weights, int size, int32_t *sums)
+{
+    for (int b = 0; b < 4; b++)
+        sums[b] = dotScalar(inputs[b], weights, size);
+}
+
+typedef int32_t (*DotProduct)(const uint8_t *, const int8_t *, int);
+typedef void (*DotProduct4)(const uint8_t *const *, const int8_t *, int, int32_t *);
+
+static DotProduct selectDotProduct()
+{
+#ifdef CORE_HAS_AVX2
+    if (cpuHasAvx2())
+        return dotAvx2;
+#endif
+
+    return dotScalar;
+}
+
+static DotProduct4 selectDotProduct4()
+{
+#ifdef CORE_HAS_AVX2
+    if (cpuHasAvx2())
+        return dot4Avx2;
+#endif
+
+    return dot4Scalar;
+}
+
+static void evaluateChunk(const Network &network, const GameState *const *states, int count, NetworkOutput *outputs,
+                          bool withPolicy)
+{
+    static const DotProduct dot = selectDotProduct();
+    static const DotProduct4 dot4 = selectDotProduct4();
+
+    alignas(32) uint8_t inputs[NET_MAX_BATCH][NET_INPUTS];
+    alignas(32) uint8_t hidden[NET_MAX_BATCH][NET_HIDDEN];
+
+    for (int b = 0; b < count; b++)
+        writeNetworkInputs(*states[b], inputs[b]);
+
+    // neuron by neuron, so each weight row stays in cache for the whole batch
+    // and is loaded into registers once per four positions
+    for (int n = 0; n < NET_HIDDEN; n++)
+    {
+        const int8_t *row = &network.hiddenWeights[n * NET_INPUTS];
+        int32_t sums[NET_MAX_BATCH];
+        int b = 0;
+
+        for (; b + 4 <= count; b += 4)
+        {
+            const uint8_t *group[4] = {inputs[b], inputs[b + 1], inputs[b + 2], inputs[b + 3]};
+            dot4(group, row, NET_INPUTS, &sums[b]);
+        }
+
+        for (; b < count; b++)
+            sums[b] = dot(inputs[b], row, NET_INPUTS);
+
+        for (b = 0; b < count; b++)
+        {
+            int32_t sum = (sums[b] + network.hiddenBias[n]) >> NET_HIDDEN_SHIFT;
+            hidden[b][n] = (uint8_t)std::min(std::max(sum, 0), NET_ACTIVATION_MAX);
+        }
+    }
+
+    for (int b = 0; b < count; b++)
+    {
+        const GameState &state = *states[b];
+        NetworkOutput &output = outputs[b];
+        std::array<float, NUM_PLAYERS> logits;
+        float maxLogit = -1e30f;
+        float total = 0.0f;
+
+        for (int i = 0; i < NUM_PLAYERS; i++)
+        {
+            logits[i] = (dot(hidden[b], &network.valueWeights[i * NET_HIDDEN], NET_HIDDEN) + network.valueBias[i]) *
+                        network.valueScale;
+            maxLogit = std::max(maxLogit, logits[i]);
+        }
+
+        for (int i = 0; i < NUM_PLAYERS; i++)
+        {
+            logits[i] = std::exp(logits[i] - maxLogit);
+            total += logits[i];
+        }
+
+        for (int i = 0; i < NUM_PLAYERS; i++)
+            output.winShares[(state.piecesIndex + i) % NUM_PLAYERS] = logits[i] / total;
+
+        if (!withPolicy)
+            continue;
+
+        for (int square = 0; square < NUM_SQUARES; square++)
+        {
+            output.policy[square] = (dot(hidden[b], &network.policyWeights[square * NET_HIDDEN], NET_HIDDEN) +
+                                     network.policyBias[square]) *
+                                    network.policyScale;
+        }
+    }
+}
+
+void evaluateNetwork(const Network &network, const GameState &state, NetworkOutput &output, bool withPolicy)
+{
+    const GameState *states[1] = {&state};
+    evaluateChunk(network, states, 1, &output, withPolicy);
+}
+
+void evaluateNetworkBatch(const Network &network, const GameState *const *states, int count, NetworkOutput *outputs,
+                          bool withPolicy)
+{
+    for (int first = 0; first < count; first += NET_MAX_BATCH)
+        evaluateChunk(network, states + first, std::min(count - first, NET_MAX_BATCH), outputs + first, withPolicy);
+}
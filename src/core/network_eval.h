@@ -0,0 +1,55 @@
+#pragma once
+
+#include "game_state.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// a small value and policy network over the board, seen from the player to move:
+// one hidden layer of NET_HIDDEN clipped ReLUs on int8 weights and uint8 activations
+const int NET_PLANES = 7;                   // visited, value, weight, then a piece plane per player
+const int NET_PLAYER_FEATURES = 3;          // remaining capacity, active and score, per player
+const int NET_INPUTS = 480;                 // the planes and player features padded to whole 32-byte blocks
+const int NET_HIDDEN = 128;
+const int NET_HIDDEN_SHIFT = 6;             // hidden sums are scaled down by 2^shift before clipping to 0..127
+const int NET_MAX_BATCH = 64;               // positions per pass of evaluateNetworkBatch
+
+static_assert(NET_PLANES * NUM_SQUARES + NET_PLAYER_FEATURES * NUM_PLAYERS <= NET_INPUTS, "inputs do not fit");
+
+struct Network
+{
+    std::vector<int8_t> hiddenWeights; // NET_HIDDEN rows of NET_INPUTS
+    std::vector<int32_t> hiddenBias;
+    std::vector<int8_t> valueWeights;  // NUM_PLAYERS rows of NET_HIDDEN, in turn order from the mover
+    std::vector<int32_t> valueBias;
+    std::vector<int8_t> policyWeights; // NUM_SQUARES rows of NET_HIDDEN
+    std::vector<int32_t> policyBias;
+    float valueScale = 1.0f / 64;      // output sums to logits
+    float policyScale = 1.0f / 64;
+};
+
+struct NetworkOutput
+{
+    std::array<float, NUM_PLAYERS> winShares; // softmax of the value head, indexed by player
+    std::array<float, NUM_SQUARES> policy;    // move logits by destination square, only legal moves mean anything,
+                                              // left unset unless the policy head was asked for
+};
+
+// small random weights, for benchmarks and as a starting point for training
+void initializeRandomNetwork(Network &network, uint64_t seed);
+
+// the binary format written by saveNetwork, false if the file is missing or does not match
+bool loadNetwork(const std::string &path, Network &network);
+bool saveNetwork(const std::string &path, const Network &network);
+
+// the quantized inputs of one position, NET_INPUTS bytes
+void writeNetworkInputs(const GameState &state, uint8_t *inputs);
+
+// the value head, and the policy head too if withPolicy, which no search uses yet
+void evaluateNetwork(const Network &network, const GameState &state, NetworkOutput &output, bool withPolicy = false);
+
+// many positions at once, each weight row is reused across the batch while it is in cache
+void evaluateNetworkBatch(const Network &network, const GameState *const *states, int count, NetworkOutput *outputs,
+                          bool withPolicy = false);
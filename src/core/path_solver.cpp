@@ -0,0 +1,195 @@
+#include "path_solver.h"
+#include "move_gen.h"
+
+#include <algorithm>
+#include <climits>
+
+// tiles with the same value and weight, in falling order of value per unit of weight
+struct TileClass
+{
+    int value;
+    int weight;
+    uint64_t mask;
+};
+
+struct SolverContext
+{
+    const GameState *state;
+    std::array<TileClass, 16 * (MAX_TILE_WEIGHT + 1)> classes;
+    int classCount = 0;
+
+    int64_t nodes = 0;
+    int64_t nodeLimit = 0;
+    bool aborted = false;
+
+    std::array<uint8_t, NUM_SQUARES> path;
+    int bestKey = INT_MIN;
+    RouteResult best;
+};
+
+// ties in points go to the lighter walk, as in setWinner
+static int routeKey(int value, int weight) { return value * (MAX_WEIGHT + 1) * 2 - weight; }
+
+static void buildClasses(SolverContext &ctx, uint64_t squares)
+{
+    const GameState &state = *ctx.state;
+
+    while (squares)
+    {
+        int square = popLowestSquare(squares);
+        int value = tileValue(state, square);
+        int weight = tileWeight(state, square);
+
+        if (value <= 0 || weight == 0)
+            continue;
+
+        int i = 0;
+
+        while (i < ctx.classCount && (ctx.classes[i].value != value || ctx.classes[i].weight != weight))
+            i++;
+
+        if (i == ctx.classCount)
+            ctx.classes[ctx.classCount++] = {value, weight, 0};
+
+        ctx.classes[i].mask |= squareBit(square);
+    }
+
+    std::sort(ctx.classes.begin(), ctx.classes.begin() + ctx.classCount,
+              [](const TileClass &a, const TileClass &b)
+              {
+                  return a.value * b.weight > b.value * a.weight;
+              });
+}
+
+static int knapsackBound(const SolverContext &ctx, uint64_t reachable, int remaining)
+{
+    int gain = 0;
+
+    for (int i = 0; i < ctx.classCount && remaining > 0; i++)
+    {
+        const TileClass &tileClass = ctx.classes[i];
+        int count = popCount(reachable & tileClass.mask);
+        int taken = std::min(count, remaining / tileClass.weight);
+
+        gain += taken * tileClass.value;
+        remaining -= taken * tileClass.weight;
+
+        if (taken < count)
+        {
+            // the fractional part of the next tile, rounded up to stay a bound
+            gain += (tileClass.value * remaining + tileClass.weight - 1) / tileClass.weight;
+            break;
+        }
+    }
+
+    return gain;
+}
+
+static uint64_t reachableSquares(const GameState &state, int square, uint64_t open, int remaining)
+{
+    uint64_t feasible = open & state.weightMasks[std::min(remaining, MAX_TILE_WEIGHT)];
+    return floodFill(squareBit(square), feasible);
+}
+
+static void searchRoutes(SolverContext &ctx, int square, uint64_t open, int remaining, int value, int weight, int length)
+{
+    const GameState &state = *ctx.state;
+
+    if (++ctx.nodes > ctx.nodeLimit && ctx.nodeLimit > 0)
+    {
+        ctx.aborted = true;
+        return;
+    }
+
+    uint64_t moves = KING_MOVES[square] & open & state.weightMasks[std::min(remaining, MAX_TILE_WEIGHT)];
+
+    if (moves == 0)
+    {
+        int key = routeKey(value, weight);
+
+        if (key > ctx.bestKey)
+        {
+            ctx.bestKey = key;
+            ctx.best.value = value;
+            ctx.best.weight = weight;
+            ctx.best.length = length;
+            std::copy(ctx.path.begin(), ctx.path.begin() + length, ctx.best.squares.begin());
+        }
+
+        return;
+    }
+
+    int bound = value + knapsackBound(ctx, reachableSquares(state, square, open, remaining), remaining);
+
+    if (routeKey(bound, weight) <= ctx.bestKey)
+        return;
+
+    // most points first, lightest first on ties, so good walks are found early
+    std::array<uint8_t, 8> order;
+    std::array<int, 8> keys;
+    int count = 0;
+
+    while (moves)
+    {
+        int dest = popLowestSquare(moves);
+        int key = tileValue(state, dest) * 8 - tileWeight(state, dest);
+        int i = count++;
+
+        while (i > 0 && keys[i - 1] < key)
+        {
+            keys[i] = keys[i - 1];
+            order[i] = order[i - 1];
+            i--;
+        }
+
+        keys[i] = key;
+        order[i] = (uint8_t)dest;
+    }
+
+    for (int i = 0; i < count && !ctx.aborted; i++)
+    {
+        int dest = order[i];
+
+        ctx.path[length] = (uint8_t)dest;
+        searchRoutes(ctx, dest, open & ~squareBit(dest), remaining - tileWeight(state, dest),
+                     value + tileValue(state, dest), weight + tileWeight(state, dest), length + 1);
+    }
+}
+
+RouteResult solveBestRoute(const GameState &state, int player, uint64_t blocked, int64_t nodeLimit)
+{
+    const PieceState &piece = state.pieces[player];
+    uint64_t open = ~state.visited & ~blocked & BOARD_MASK;
+    int remaining = MAX_WEIGHT - piece.currentWeight;
+
+    if (!isActive(state, player))
+        return RouteResult();
+
+    SolverContext ctx;
+    ctx.state = &state;
+    ctx.nodeLimit = nodeLimit;
+
+    buildClasses(ctx, reachableSquares(state, piece.square, open, remaining));
+    searchRoutes(ctx, piece.square, open, remaining, 0, 0, 0);
+
+    ctx.best.nodes = ctx.nodes;
+    ctx.best.isComplete = !ctx.aborted;
+    return ctx.best;
+}
+
+int routeUpperBound(const GameState &state, int player, uint64_t blocked)
+{
+    if (!isActive(state, player))
+        return 0;
+
+    const PieceState &piece = state.pieces[player];
+    uint64_t open = ~state.visited & ~blocked & BOARD_MASK;
+    int remaining = MAX_WEIGHT - piece.currentWeight;
+    uint64_t reachable = reachableSquares(state, piece.square, open, remaining);
+
+    SolverContext ctx;
+    ctx.state = &state;
+    buildClasses(ctx, reachable);
+
+    return knapsackBound(ctx, reachable, remaining);
+}
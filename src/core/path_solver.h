@@ -0,0 +1,26 @@
+#pragma once
+
+#include "game_state.h"
+
+#include <array>
+#include <cstdint>
+
+// the best walk one piece can still make on its own, ignoring the other pieces.
+// A piece has to keep moving while it has a legal move, so walks only end when boxed in.
+struct RouteResult
+{
+    int value = 0;  // points collected along the walk
+    int weight = 0; // weight added along the walk
+    int length = 0;
+    std::array<uint8_t, NUM_SQUARES> squares;
+    int64_t nodes = 0;
+    bool isComplete = true; // false if the node limit cut the search short
+};
+
+// branch and bound over the player's walks through unvisited squares outside blocked.
+// With nodeLimit > 0 the search stops early and returns the best walk found so far.
+RouteResult solveBestRoute(const GameState &state, int player, uint64_t blocked = 0, int64_t nodeLimit = 0);
+
+// an upper bound on the points the player can still collect: the best fractional
+// knapsack of positive tiles reachable within the remaining capacity
+int routeUpperBound(const GameState &state, int player, uint64_t blocked = 0);
@@ -0,0 +1,401 @@
+#include "ratings.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+
+const int RATING_MAX_ITERATIONS = 1000;
+const double RATING_TOLERANCE = 1e-7; // largest change in log strength that still counts as converged
+const double ELO_PER_NATURAL_LOG = 400.0 / 2.302585092994046;
+
+// a game as a finishing order, with bit i of tiedWithNext set when place i ties place i + 1
+struct RankedGame
+{
+    std::array<uint16_t, NUM_PLAYERS> players;
+    uint8_t tiedWithNext;
+};
+
+bool appendRatedGames(const std::string &path, const std::vector<std::string> &names, const std::vector<RatedGame> &games)
+{
+    std::FILE *file = std::fopen(path.c_str(), "a");
+
+    if (!file)
+        return false;
+
+    for (const RatedGame &game : games)
+    {
+        for (int seat = 0; seat < NUM_PLAYERS; seat++)
+            std::fprintf(file, "%s,", names[game.players[seat]].c_str());
+
+        for (int seat = 0; seat < NUM_PLAYERS; seat++)
+            std::fprintf(file, "%d,", game.scores[seat]);
+
+        std::fprintf(file, "%d,%d,%d,%d\n", game.weights[0], game.weights[1], game.weights[2], game.weights[3]);
+    }
+
+    return std::fclose(file) == 0;
+}
+
+bool loadRatedGames(const std::string &path, std::vector<std::string> &names, std::vector<RatedGame> &games)
+{
+    std::FILE *file = std::fopen(path.c_str(), "r");
+
+    if (!file)
+        return false;
+
+    std::unordered_map<std::string, uint16_t> index;
+    char line[1024];
+
+    for (size_t i = 0; i < names.size(); i++)
+        index[names[i]] = (uint16_t)i;
+
+    while (std::fgets(line, sizeof(line), file))
+    {
+        char *fields[3 * NUM_PLAYERS];
+        int count = 0;
+        char *cursor = line;
+
+        line[std::strcspn(line, "\r\n")] = '\0';
+
+        while (count < 3 * NUM_PLAYERS)
+        {
+            fields[count++] = cursor;
+            cursor = std::strchr(cursor, ',');
+
+            if (!cursor)
+                break;
+
+            *cursor++ = '\0';
+        }
+
+        // blank or malformed lines are skipped
+        if (count < 3 * NUM_PLAYERS || cursor)
+            continue;
+
+        RatedGame game;
+
+        for (int seat = 0; seat < NUM_PLAYERS; seat++)
+        {
+            auto found = index.emplace(fields[seat], (uint16_t)names.size());
+
+            if (found.second)
+                names.push_back(fields[seat]);
+
+            game.players[seat] = found.first->second;
+            game.scores[seat] = (int16_t)std::atoi(fields[NUM_PLAYERS + seat]);
+            game.weights[seat] = (uint8_t)std::atoi(fields[2 * NUM_PLAYERS + seat]);
+        }
+
+        games.push_back(game);
+    }
+
+    std::fclose(file);
+    return true;
+}
+
+// orders seats the way setWinner ranks them: higher score first, then lower weight
+static RankedGame rankGame(const RatedGame &game)
+{
+    RankedGame ranked;
+    std::array<int, NUM_PLAYERS> seats = {0, 1, 2, 3};
+
+    auto better = [&](int a, int b)
+    {
+        if (game.scores[a] != game.scores[b])
+            return game.scores[a] > game.scores[b];
+
+        return game.weights[a] < game.weights[b];
+    };
+
+    std::sort(seats.begin(), seats.end(), better);
+    ranked.tiedWithNext = 0;
+
+    for (int place = 0; place < NUM_PLAYERS; place++)
+    {
+        ranked.players[place] = game.players[seats[place]];
+
+        if (place + 1 < NUM_PLAYERS && !better(seats[place], seats[place + 1]))
+            ranked.tiedWithNext |= 1 << place;
+    }
+
+    return ranked;
+}
+
+// Calls visit(first, end) for every place that tells the players apart: players
+// first..end-1 of the finishing order are picked from everyone still left. Tied
+// players are picked together, each against the whole remaining field, and the
+// last group left is picked for certain, so it is skipped.
+template <typename Visit>
+static void forEachPick(const RankedGame &game, Visit visit)
+{
+    int first = 0;
+
+    while (first < NUM_PLAYERS)
+    {
+        int end = first + 1;
+
+        while (end < NUM_PLAYERS && (game.tiedWithNext & (1 << (end - 1))))
+            end++;
+
+        if (end == NUM_PLAYERS)
+            return;
+
+        visit(first, end);
+        first = end;
+    }
+}
+
+// inverts a symmetric positive definite matrix in place by Gauss-Jordan elimination
+static void invertMatrix(std::vector<double> &matrix, int size)
+{
+    std::vector<double> inverse(size * size, 0.0);
+
+    for (int i = 0; i < size; i++)
+        inverse[i * size + i] = 1.0;
+
+    for (int column = 0; column < size; column++)
+    {
+        int pivot = column;
+
+        for (int row = column + 1; row < size; row++)
+        {
+            if (std::fabs(matrix[row * size + column]) > std::fabs(matrix[pivot * size + column]))
+                pivot = row;
+        }
+
+        for (int k = 0; k < size; k++)
+        {
+            std::swap(matrix[column * size + k], matrix[pivot * size + k]);
+            std::swap(inverse[column * size + k], inverse[pivot * size + k]);
+        }
+
+        double scale = 1.0 / matrix[column * size + column];
+
+        for (int k = 0; k < size; k++)
+        {
+            matrix[column * size + k] *= scale;
+            inverse[column * size + k] *= scale;
+        }
+
+        for (int row = 0; row < size; row++)
+        {
+            double factor = matrix[row * size + column];
+
+            if (row == column || factor == 0.0)
+                continue;
+
+            for (int k = 0; k < size; k++)
+            {
+                matrix[row * size + k] -= factor * matrix[column * size + k];
+                inverse[row * size + k] -= factor * inverse[column * size + k];
+            }
+        }
+    }
+
+    matrix.swap(inverse);
+}
+
+RatingResult fitRatings(const std::vector<RatedGame> &games, int playerCount, int threads)
+{
+    RatingResult result;
+    int chunks = std::max(threads, 1);
+    size_t chunkSize = (games.size() + chunks - 1) / chunks;
+    std::vector<RankedGame> ranked(games.size());
+    std::vector<std::vector<double>> partial(chunks);
+    std::vector<double> strength(playerCount, 1.0);
+    std::vector<double> wins(playerCount, 0.0);
+    ThreadPool pool(chunks);
+
+    // runs work(chunk, begin, end) over the games split into one slice per worker
+    auto runChunks = [&](const std::function<void(int, size_t, size_t)> &work)
+    {
+        for (int chunk = 0; chunk < chunks; chunk++)
+        {
+            size_t begin = std::min(games.size(), chunk * chunkSize);
+            size_t end = std::min(games.size(), begin + chunkSize);
+
+            pool.submit([&work, chunk, begin, end]() { work(chunk, begin, end); });
+        }
+
+        pool.wait();
+    };
+
+    // ranks every game once and counts how often each player is picked
+    runChunks([&](int chunk, size_t begin, size_t end)
+              {
+                  std::vector<double> &picks = partial[chunk];
+                  picks.assign(playerCount, 0.0);
+
+                  for (size_t i = begin; i < end; i++)
+                  {
+                      ranked[i] = rankGame(games[i]);
+                      forEachPick(ranked[i], [&](int first, int last)
+                                  {
+                                      for (int place = first; place < last; place++)
+                                          picks[ranked[i].players[place]]++;
+                                  });
+                  }
+              });
+
+    result.games.assign(playerCount, 0);
+
+    for (const RatedGame &game : games)
+    {
+        for (int seat = 0; seat < NUM_PLAYERS; seat++)
+            result.games[game.players[seat]]++;
+    }
+
+    // a virtual win and loss against an average player keeps a bot that always
+    // or never wins at a finite rating
+    for (int player = 0; player < playerCount; player++)
+    {
+        wins[player] = 1.0;
+
+        for (int chunk = 0; chunk < chunks; chunk++)
+            wins[player] += partial[chunk][player];
+    }
+
+    // MM update: a player's strength becomes its picks over the sum, across every pick
+    // it was still in the running for, of picked players over the field's strength
+    while (result.iterations < RATING_MAX_ITERATIONS && !result.converged)
+    {
+        runChunks([&](int chunk, size_t begin, size_t end)
+                  {
+                      std::vector<double> &expected = partial[chunk];
+                      expected.assign(playerCount, 0.0);
+
+                      for (size_t i = begin; i < end; i++)
+                      {
+                          const RankedGame &game = ranked[i];
+
+                          forEachPick(game, [&](int first, int last)
+                                      {
+                                          double field = 0.0;
+
+                                          for (int place = first; place < NUM_PLAYERS; place++)
+                                              field += strength[game.players[place]];
+
+                                          double share = (last - first) / field;
+
+                                          for (int place = first; place < NUM_PLAYERS; place++)
+                                              expected[game.players[place]] += share;
+                                      });
+                      }
+                  });
+
+        std::vector<double> updated(playerCount);
+        double meanLog = 0.0;
+        double largestChange = 0.0;
+
+        for (int player = 0; player < playerCount; player++)
+        {
+            double expected = 2.0 / (strength[player] + 1.0);
+
+            for (int chunk = 0; chunk < chunks; chunk++)
+                expected += partial[chunk][player];
+
+            updated[player] = wins[player] / expected;
+            meanLog += std::log(updated[player]) / playerCount;
+        }
+
+        // the average player is the prior's opponent, so keep it at strength 1. The
+        // prior alone pins the overall scale too weakly for MM to settle it quickly.
+        for (int player = 0; player < playerCount; player++)
+        {
+            double rescaled = updated[player] / std::exp(meanLog);
+            largestChange = std::max(largestChange, std::fabs(std::log(rescaled / strength[player])));
+            strength[player] = rescaled;
+        }
+
+        result.iterations++;
+        result.converged = largestChange < RATING_TOLERANCE;
+    }
+
+    // Fisher information of the log strengths: each pick of m players from a field
+    // adds m * (diag(p) - p p^T), with p each player's share of the field's strength
+    runChunks([&](int chunk, size_t begin, size_t end)
+              {
+                  std::vector<double> &information = partial[chunk];
+                  information.assign((size_t)playerCount * playerCount, 0.0);
+
+                  for (size_t i = begin; i < end; i++)
+                  {
+                      const RankedGame &game = ranked[i];
+
+                      forEachPick(game, [&](int first, int last)
+                                  {
+                                      double field = 0.0;
+
+                                      for (int place = first; place < NUM_PLAYERS; place++)
+                                          field += strength[game.players[place]];
+
+                                      double picked = last - first;
+
+                                      for (int a = first; a < NUM_PLAYERS; a++)
+                                      {
+                                          int playerA = game.players[a];
+                                          double shareA = strength[playerA] / field;
+
+                                          information[(size_t)playerA * playerCount + playerA] += picked * shareA;
+
+                                          for (int b = first; b < NUM_PLAYERS; b++)
+                                          {
+                                              int playerB = game.players[b];
+                                              information[(size_t)playerA * playerCount + playerB] -=
+                                                  picked * shareA * strength[playerB] / field;
+                                          }
+                                      }
+                                  });
+                  }
+              });
+
+    std::vector<double> covariance((size_t)playerCount * playerCount, 0.0);
+
+    for (int player = 0; player < playerCount; player++)
+    {
+        double share = strength[player] / (strength[player] + 1.0);
+        covariance[(size_t)player * playerCount + player] = 2.0 * share * (1.0 - share);
+    }
+
+    for (int chunk = 0; chunk < chunks; chunk++)
+    {
+        for (size_t i = 0; i < covariance.size(); i++)
+            covariance[i] += partial[chunk][i];
+    }
+
+    invertMatrix(covariance, playerCount);
+
+    // ratings are reported against the mean bot, so the error of each is that of
+    // its log strength minus the mean log strength
+    double meanLog = 0.0;
+    double meanCovariance = 0.0;
+    std::vector<double> rowMeans(playerCount, 0.0);
+
+    for (int a = 0; a < playerCount; a++)
+    {
+        meanLog += std::log(strength[a]) / playerCount;
+
+        for (int b = 0; b < playerCount; b++)
+            rowMeans[a] += covariance[(size_t)a * playerCount + b] / playerCount;
+
+        meanCovariance += rowMeans[a] / playerCount;
+    }
+
+    result.elo.resize(playerCount);
+    result.eloError.resize(playerCount);
+
+    for (int player = 0; player < playerCount; player++)
+    {
+        double variance = covariance[(size_t)player * playerCount + player] - 2.0 * rowMeans[player] + meanCovariance;
+
+        result.elo[player] = ELO_PER_NATURAL_LOG * (std::log(strength[player]) - meanLog);
+        result.eloError[player] = ELO_PER_NATURAL_LOG * std::sqrt(std::max(variance, 0.0));
+    }
+
+    return result;
+}
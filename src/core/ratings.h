@@ -0,0 +1,39 @@
+#pragma once
+
+#include "game_state.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// one finished four-player game between rated bots, indexed by seat
+struct RatedGame
+{
+    std::array<uint16_t, NUM_PLAYERS> players; // index into the list of bot names
+    std::array<int16_t, NUM_PLAYERS> scores;
+    std::array<uint8_t, NUM_PLAYERS> weights;
+};
+
+struct RatingResult
+{
+    std::vector<double> elo;      // centred on the mean bot
+    std::vector<double> eloError; // one standard error, from the inverse Fisher information
+    std::vector<int64_t> games;   // seat games played by each bot
+    int iterations = 0;
+    bool converged = false;
+};
+
+// results files hold one game per line, in seat order:
+//   name1,name2,name3,name4,score1,score2,score3,score4,weight1,weight2,weight3,weight4
+// Appends games to path, writing each player as names[player].
+bool appendRatedGames(const std::string &path, const std::vector<std::string> &names, const std::vector<RatedGame> &games);
+
+// reads every game in path, adding new bot names to names. False if the file cannot be read.
+bool loadRatedGames(const std::string &path, std::vector<std::string> &names, std::vector<RatedGame> &games);
+
+// Plackett-Luce ratings: each game is read as a finishing order, picked best first, each
+// place going to a player with chance proportional to its strength. Players tied by
+// setWinner's rule (same score and weight) are picked together. Fitted with Hunter's
+// MM iterations, the games split across threads.
+RatingResult fitRatings(const std::vector<RatedGame> &games, int playerCount, int threads = 1);
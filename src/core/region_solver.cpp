@@ -0,0 +1,141 @@
+#include "region_solver.h"
+#include "move_gen.h"
+#include "zobrist.h"
+
+#include <algorithm>
+#include <future>
+#include <vector>
+
+// regions smaller than this are solved on the calling thread, a thread costs more than the solve
+const int PARALLEL_REGION_SQUARES = 16;
+
+int findRegions(uint64_t open, std::array<uint64_t, NUM_SQUARES> &regions)
+{
+    int count = 0;
+
+    open &= BOARD_MASK;
+
+    while (open)
+    {
+        uint64_t seed = squareBit(lowestSquare(open));
+        uint64_t region = seed | floodFill(seed, open);
+
+        regions[count++] = region;
+        open &= ~region;
+    }
+
+    return count;
+}
+
+uint64_t pieceRegion(const GameState &state, int player)
+{
+    const PieceState &piece = state.pieces[player];
+    int remaining = MAX_WEIGHT - piece.currentWeight;
+    uint64_t open = ~state.visited & state.weightMasks[std::min(remaining, MAX_TILE_WEIGHT)];
+
+    return floodFill(squareBit(piece.square), open);
+}
+
+// grows every piece's region one step at a time, so pieces that meet are
+// rejected after a few steps instead of after full floods
+bool arePiecesSeparated(const GameState &state)
+{
+    std::array<uint64_t, NUM_PLAYERS> open;
+    std::array<uint64_t, NUM_PLAYERS> reached = {};
+    std::array<uint64_t, NUM_PLAYERS> frontier = {};
+    uint64_t claimed = 0;
+    uint64_t growing = 0;
+
+    for (int player = 0; player < NUM_PLAYERS; player++)
+    {
+        if (!isActive(state, player))
+            continue;
+
+        int remaining = MAX_WEIGHT - state.pieces[player].currentWeight;
+        open[player] = ~state.visited & state.weightMasks[std::min(remaining, MAX_TILE_WEIGHT)];
+        frontier[player] = squareBit(state.pieces[player].square);
+        growing |= frontier[player];
+    }
+
+    while (growing)
+    {
+        growing = 0;
+
+        for (int player = 0; player < NUM_PLAYERS; player++)
+        {
+            if (!frontier[player])
+                continue;
+
+            frontier[player] = kingDilate(frontier[player]) & open[player] & ~reached[player];
+
+            if (frontier[player] & (claimed & ~reached[player]))
+                return false;
+
+            reached[player] |= frontier[player];
+            claimed |= frontier[player];
+            growing |= frontier[player];
+        }
+    }
+
+    return true;
+}
+
+bool solveSeparatedEndgame(const GameState &state, EndgameResult &result, int64_t nodeLimit, bool parallel)
+{
+    if (!arePiecesSeparated(state))
+        return false;
+
+    std::vector<std::future<RouteResult>> pending(NUM_PLAYERS);
+
+    for (int player = 0; player < NUM_PLAYERS; player++)
+    {
+        result.routes[player] = RouteResult();
+
+        if (!isActive(state, player))
+            continue;
+
+        if (parallel && popCount(pieceRegion(state, player)) >= PARALLEL_REGION_SQUARES)
+            pending[player] = std::async(std::launch::async, solveBestRoute, std::cref(state), player, 0, nodeLimit);
+        else
+            result.routes[player] = solveBestRoute(state, player, 0, nodeLimit);
+    }
+
+    result.isComplete = true;
+
+    for (int player = 0; player < NUM_PLAYERS; player++)
+    {
+        if (pending[player].valid())
+            result.routes[player] = pending[player].get();
+
+        const PieceState &piece = state.pieces[player];
+        result.finalScores[player] = piece.score + result.routes[player].value;
+        result.finalWeights[player] = piece.currentWeight + result.routes[player].weight;
+        result.isComplete = result.isComplete && result.routes[player].isComplete;
+    }
+
+    return true;
+}
+
+void applyEndgameResult(GameState &state, const EndgameResult &result)
+{
+    for (int player = 0; player < NUM_PLAYERS; player++)
+    {
+        const RouteResult &route = result.routes[player];
+
+        for (int i = 0; i < route.length; i++)
+        {
+            state.visited |= squareBit(route.squares[i]);
+            state.occupancy[player] |= squareBit(route.squares[i]);
+        }
+
+        if (route.length > 0)
+            state.pieces[player].square = route.squares[route.length - 1];
+
+        state.pieces[player].score = (int16_t)result.finalScores[player];
+        state.pieces[player].currentWeight = (uint8_t)result.finalWeights[player];
+    }
+
+    state.activeMask = 0;
+    finishTurn(state);
+    state.hash = computeHash(state);
+}
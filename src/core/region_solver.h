@@ -0,0 +1,31 @@
+#pragma once
+
+#include "game_state.h"
+#include "path_solver.h"
+
+#include <array>
+#include <cstdint>
+
+// the unvisited squares split into king-connected regions, returns the region count
+int findRegions(uint64_t open, std::array<uint64_t, NUM_SQUARES> &regions);
+
+// the unvisited squares the player's piece can still reach, given its remaining capacity
+uint64_t pieceRegion(const GameState &state, int player);
+
+// true when no two active pieces can reach a common square, so none can affect another
+bool arePiecesSeparated(const GameState &state);
+
+struct EndgameResult
+{
+    std::array<RouteResult, NUM_PLAYERS> routes;
+    std::array<int, NUM_PLAYERS> finalScores;
+    std::array<int, NUM_PLAYERS> finalWeights;
+    bool isComplete = false; // every route was solved exactly within the node limit
+};
+
+// solves every active piece's route on its own, in parallel for large regions.
+// Returns false without solving if the pieces are not separated.
+bool solveSeparatedEndgame(const GameState &state, EndgameResult &result, int64_t nodeLimit = 0, bool parallel = true);
+
+// the position with every piece at the end of its solved route, ready for setWinner
+void applyEndgameResult(GameState &state, const EndgameResult &result);
@@ -0,0 +1,431 @@
+#include "search_bot.h"
+#include "move_gen.h"
+#include "region_solver.h"
+#include "territory_eval.h"
+#include "zobrist.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+
+// eval units credited per unit of unused capacity while a piece can still move
+const int FUTURE_WEIGHT_VALUE = 24;
+
+// territory points are only a forecast, they count for this share of scored points
+const int TERRITORY_NUMERATOR = 1;
+const int TERRITORY_DENOMINATOR = 4;
+
+// eval units for a whole win share predicted by the network
+const int NETWORK_VALUE_SCALE = 64 * EVAL_SCALE;
+
+const int SEARCH_INFINITY = INT_MAX / 2;
+
+// per-piece node budget for the route solver once the pieces are separated
+const int64_t ENDGAME_NODE_LIMIT = 20000;
+
+// the separation check costs about as much as a node, so it is only worth it
+// where a solved endgame replaces at least a few plies of tree
+const int ENDGAME_MIN_DEPTH = 2;
+
+struct SearchContext
+{
+    GameState state;
+    MoveStack stack;
+    int rootPlayer;
+    Evaluation evaluation;
+    const Network *network;
+    uint64_t rootKey;
+    TranspositionTable *table;
+    const std::atomic<bool> *stop;
+    std::chrono::steady_clock::time_point deadline;
+    int64_t nodes = 0;
+    bool aborted = false;
+    bool hitDepthLimit = false;
+};
+
+static int playerValue(const GameState &state, int player)
+{
+    const PieceState &piece = state.pieces[player];
+    int unusedWeight = MAX_WEIGHT - piece.currentWeight;
+
+    if (isActive(state, player))
+        return piece.score * EVAL_SCALE + unusedWeight * FUTURE_WEIGHT_VALUE;
+
+    return piece.score * EVAL_SCALE + unusedWeight;
+}
+
+static int territoryValue(const GameState &state, const Territory &territory, int player)
+{
+    const PieceState &piece = state.pieces[player];
+    int unusedWeight = MAX_WEIGHT - piece.currentWeight - territory.weight[player];
+
+    if (!isActive(state, player))
+        return playerValue(state, player);
+
+    return piece.score * EVAL_SCALE +
+           territory.value[player] * EVAL_SCALE * TERRITORY_NUMERATOR / TERRITORY_DENOMINATOR + unusedWeight;
+}
+
+// each player's value minus the best opponent's, positive only for the leader
+std::array<int, NUM_PLAYERS> evaluateMargins(const GameState &state, Evaluation evaluation, const Network *network)
+{
+    std::array<int, NUM_PLAYERS> values;
+    std::array<int, NUM_PLAYERS> margins;
+
+    if (evaluation == Evaluation::Network && network && state.isGameOver)
+    {
+        // a finished game is worth its actual win shares, so it compares with the network's guesses
+        int winners = countWinner(state);
+
+        for (int player = 0; player < NUM_PLAYERS; player++)
+            values[player] = isWinner(state, player) ? NETWORK_VALUE_SCALE / winners : 0;
+    }
+    else if (evaluation == Evaluation::Network && network)
+    {
+        NetworkOutput output;
+        evaluateNetwork(*network, state, output);
+
+        for (int player = 0; player < NUM_PLAYERS; player++)
+            values[player] = (int)(output.winShares[player] * NETWORK_VALUE_SCALE);
+    }
+    else if (evaluation != Evaluation::Material && !state.isGameOver)
+    {
+        Territory territory = computeTerritory(state);
+
+        for (int player = 0; player < NUM_PLAYERS; player++)
+            values[player] = territoryValue(state, territory, player);
+    }
+    else
+    {
+        for (int player = 0; player < NUM_PLAYERS; player++)
+            values[player] = playerValue(state, player);
+    }
+
+    for (int player = 0; player < NUM_PLAYERS; player++)
+    {
+        int bestOpponent = -SEARCH_INFINITY;
+
+        for (int opponent = 0; opponent < NUM_PLAYERS; opponent++)
+        {
+            if (opponent != player)
+                bestOpponent = std::max(bestOpponent, values[opponent]);
+        }
+
+        margins[player] = values[player] - bestOpponent;
+    }
+
+    return margins;
+}
+
+// highest value first, lowest weight on ties, the same preference as the greedy player
+static int orderMoves(const GameState &state, uint64_t legalMoves, std::array<uint8_t, 8> &moves)
+{
+    std::array<int, 8> keys;
+    int count = 0;
+
+    while (legalMoves)
+    {
+        int square = popLowestSquare(legalMoves);
+        int key = tileValue(state, square) * 8 - tileWeight(state, square);
+        int i = count++;
+
+        while (i > 0 && keys[i - 1] < key)
+        {
+            keys[i] = keys[i - 1];
+            moves[i] = moves[i - 1];
+            i--;
+        }
+
+        keys[i] = key;
+        moves[i] = (uint8_t)square;
+    }
+
+    return count;
+}
+
+static void moveToFront(std::array<uint8_t, 8> &moves, int count, int move)
+{
+    for (int i = 1; i < count; i++)
+    {
+        if (moves[i] == move)
+        {
+            std::rotate(moves.begin(), moves.begin() + i, moves.begin() + i + 1);
+            return;
+        }
+    }
+}
+
+// once the pieces can no longer meet, every piece just walks its best route,
+// so the game's outcome is the solved routes instead of a joint four-player tree
+static bool solveEndgame(const SearchContext &ctx, const GameState &state, std::array<int, NUM_PLAYERS> &margins)
+{
+    EndgameResult endgame;
+
+    if (!solveSeparatedEndgame(state, endgame, ENDGAME_NODE_LIMIT, false) || !endgame.isComplete)
+        return false;
+
+    GameState finished = state;
+    applyEndgameResult(finished, endgame);
+    margins = evaluateMargins(finished, ctx.evaluation, ctx.network);
+    return true;
+}
+
+static bool checkTime(SearchContext &ctx)
+{
+    if ((++ctx.nodes & 1023) == 0 &&
+        (std::chrono::steady_clock::now() >= ctx.deadline || (ctx.stop && ctx.stop->load(std::memory_order_relaxed))))
+        ctx.aborted = true;
+
+    return ctx.aborted;
+}
+
+static int searchParanoid(SearchContext &ctx, int depth, int alpha, int beta)
+{
+    if (checkTime(ctx))
+        return 0;
+
+    GameState &state = ctx.state;
+
+    if (state.isGameOver)
+        return evaluateMargins(state, ctx.evaluation, ctx.network)[ctx.rootPlayer];
+
+    uint64_t key = state.hash ^ ctx.rootKey;
+    TTData entry;
+    int ttMove = -1;
+    bool found = ctx.table && ctx.table->probe(key, entry);
+    std::array<int, NUM_PLAYERS> margins;
+
+    if (depth >= ENDGAME_MIN_DEPTH && !(found && entry.depth == RESOLVED_DEPTH) && solveEndgame(ctx, state, margins))
+    {
+        if (ctx.table)
+        {
+            TTData data;
+            data.value = margins[ctx.rootPlayer];
+            data.depth = RESOLVED_DEPTH;
+            data.bound = BoundType::Exact;
+            ctx.table->store(key, data);
+        }
+
+        return margins[ctx.rootPlayer];
+    }
+
+    if (depth == 0)
+    {
+        ctx.hitDepthLimit = true;
+        return evaluateMargins(state, ctx.evaluation, ctx.network)[ctx.rootPlayer];
+    }
+
+    if (found)
+    {
+        ttMove = entry.bestMove;
+
+        if (entry.depth >= depth &&
+            (entry.bound == BoundType::Exact ||
+             (entry.bound == BoundType::Lower && entry.value >= beta) ||
+             (entry.bound == BoundType::Upper && entry.value <= alpha)))
+        {
+            if (entry.depth != RESOLVED_DEPTH)
+                ctx.hitDepthLimit = true;
+
+            return entry.value;
+        }
+    }
+
+    std::array<uint8_t, 8> moves;
+    int count = orderMoves(state, getLegalMoves(state, state.piecesIndex), moves);
+    bool maximizing = state.piecesIndex == ctx.rootPlayer;
+    int best = maximizing ? -SEARCH_INFINITY : SEARCH_INFINITY;
+    int bestMove = moves[0];
+    int alphaOrig = alpha;
+    int betaOrig = beta;
+    bool parentHitDepthLimit = ctx.hitDepthLimit;
+
+    moveToFront(moves, count, ttMove);
+    ctx.hitDepthLimit = false;
+
+    for (int i = 0; i < count; i++)
+    {
+        makeMove(state, moves[i], ctx.stack);
+        int value = searchParanoid(ctx, depth - 1, alpha, beta);
+        unmakeMove(state, ctx.stack);
+
+        if (ctx.aborted)
+            return 0;
+
+        if (maximizing ? value > best : value < best)
+        {
+            best = value;
+            bestMove = moves[i];
+        }
+
+        if (maximizing)
+            alpha = std::max(alpha, best);
+        else
+            beta = std::min(beta, best);
+
+        if (alpha >= beta)
+            break;
+    }
+
+    if (ctx.table)
+    {
+        TTData data;
+        data.value = best;
+        data.depth = ctx.hitDepthLimit ? depth : RESOLVED_DEPTH;
+        data.bound = best <= alphaOrig ? BoundType::Upper : best >= betaOrig ? BoundType::Lower : BoundType::Exact;
+        data.bestMove = bestMove;
+        ctx.table->store(key, data);
+    }
+
+    ctx.hitDepthLimit |= parentHitDepthLimit;
+    return best;
+}
+
+static std::array<int, NUM_PLAYERS> searchMaxN(SearchContext &ctx, int depth)
+{
+    GameState &state = ctx.state;
+
+    if (checkTime(ctx) || state.isGameOver)
+        return evaluateMargins(state, ctx.evaluation, ctx.network);
+
+    std::array<int, NUM_PLAYERS> margins;
+
+    if (depth >= ENDGAME_MIN_DEPTH && solveEndgame(ctx, state, margins))
+        return margins;
+
+    if (depth == 0)
+    {
+        ctx.hitDepthLimit = true;
+        return evaluateMargins(state, ctx.evaluation, ctx.network);
+    }
+
+    // max^n values do not fit an entry, the table only remembers the best move for ordering
+    uint64_t key = state.hash ^ ctx.rootKey;
+    TTData entry;
+    std::array<uint8_t, 8> moves;
+    int count = orderMoves(state, getLegalMoves(state, state.piecesIndex), moves);
+    int player = state.piecesIndex;
+    int bestMove = moves[0];
+    std::array<int, NUM_PLAYERS> best;
+    best[player] = -SEARCH_INFINITY;
+
+    if (ctx.table && ctx.table->probe(key, entry))
+        moveToFront(moves, count, entry.bestMove);
+
+    for (int i = 0; i < count; i++)
+    {
+        makeMove(state, moves[i], ctx.stack);
+        std::array<int, NUM_PLAYERS> values = searchMaxN(ctx, depth - 1);
+        unmakeMove(state, ctx.stack);
+
+        if (ctx.aborted)
+            return best;
+
+        if (values[player] > best[player])
+        {
+            best = values;
+            bestMove = moves[i];
+        }
+    }
+
+    if (ctx.table)
+    {
+        TTData data;
+        data.depth = depth;
+        data.bestMove = bestMove;
+        ctx.table->store(key, data);
+    }
+
+    return best;
+}
+
+static int searchRootMove(SearchContext &ctx, const SearchConfig &config, int move, int depth, int alpha)
+{
+    int value;
+
+    makeMove(ctx.state, move, ctx.stack);
+
+    if (config.mode == SearchMode::Paranoid)
+        value = searchParanoid(ctx, depth - 1, alpha, SEARCH_INFINITY);
+    else
+        value = searchMaxN(ctx, depth - 1)[ctx.rootPlayer];
+
+    unmakeMove(ctx.state, ctx.stack);
+
+    return value;
+}
+
+// iterative deepening, keeping the result of the last iteration that finished in time
+SearchResult searchBestMove(const GameState &state, const SearchConfig &config)
+{
+    SearchResult result;
+
+    if (state.isGameOver)
+        return result;
+
+    SearchContext ctx;
+    ctx.state = state;
+    ctx.rootPlayer = state.piecesIndex;
+    ctx.evaluation = config.evaluation;
+    ctx.network = config.network;
+    ctx.rootKey = ROOT_PLAYER_KEYS[ctx.rootPlayer] ^ (config.mode == SearchMode::MaxN ? MAXN_SEARCH_KEY : 0) ^
+                  EVALUATION_KEYS[(int)config.evaluation];
+    ctx.table = config.table;
+    ctx.stop = config.stop;
+
+    std::array<uint8_t, 8> moves;
+    int count = orderMoves(state, getLegalMoves(state, state.piecesIndex), moves);
+
+    result.bestMove = moves[0];
+
+    if (count == 1)
+        return result;
+
+    ctx.deadline = std::chrono::steady_clock::now() +
+                   std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                       std::chrono::duration<double>(config.timeBudget));
+
+    if (ctx.table && config.newGeneration)
+        ctx.table->newSearch();
+
+    for (int depth = 1; depth <= config.maxDepth; depth++)
+    {
+        int bestValue = -SEARCH_INFINITY;
+        int bestIndex = 0;
+
+        ctx.hitDepthLimit = false;
+
+        for (int i = 0; i < count; i++)
+        {
+            int value = searchRootMove(ctx, config, moves[i], depth, bestValue);
+
+            if (ctx.aborted)
+                break;
+
+            if (value > bestValue)
+            {
+                bestValue = value;
+                bestIndex = i;
+            }
+        }
+
+        if (ctx.aborted)
+            break;
+
+        // search the previous best move first on the next iteration
+        std::rotate(moves.begin(), moves.begin() + bestIndex, moves.begin() + bestIndex + 1);
+
+        result.bestMove = moves[0];
+        result.depth = depth;
+        result.value = bestValue;
+
+        if (!ctx.hitDepthLimit)
+        {
+            result.isExact = true;
+            break;
+        }
+    }
+
+    result.nodes = ctx.nodes;
+    return result;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "game_state.h"
+#include "network_eval.h"
+#include "transposition_table.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+enum class SearchMode
+{
+    Paranoid, // every opponent plays to minimize the searching player's margin
+    MaxN      // every player maximizes their own margin
+};
+
+enum class Evaluation
+{
+    Material, // score plus a flat credit for unused capacity
+    Territory, // score plus the best tiles in the squares each piece reaches first
+    Network    // the value head of SearchConfig::network, territory when there is none. Finished and
+               // solved positions then count their actual win shares, on the network's scale
+};
+
+struct SearchConfig
+{
+    SearchMode mode = SearchMode::Paranoid;
+    Evaluation evaluation = Evaluation::Territory;
+    const Network *network = nullptr;
+    int maxDepth = NUM_SQUARES;
+    double timeBudget = 0.5; // seconds
+    TranspositionTable *table = nullptr; // optional, may be shared with other searches
+    const std::atomic<bool> *stop = nullptr; // optional, ends the search early when set
+
+    // false when the caller has already started a table generation for a group of
+    // searches, so their entries do not age each other out
+    bool newGeneration = true;
+};
+
+struct SearchResult
+{
+    int bestMove = -1;
+    int depth = 0; // deepest fully searched iteration
+    int value = 0; // the mover's margin over the best opponent, in eval units
+    int64_t nodes = 0;
+    bool isExact = false; // the last iteration reached the end of every line
+};
+
+// eval units per point of score, weight left over breaks ties below one point
+const int EVAL_SCALE = 32;
+
+std::array<int, NUM_PLAYERS> evaluateMargins(const GameState &state, Evaluation evaluation = Evaluation::Material,
+                                             const Network *network = nullptr);
+SearchResult searchBestMove(const GameState &state, const SearchConfig &config);
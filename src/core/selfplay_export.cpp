@@ -0,0 +1,195 @@
+#include "selfplay_export.h"
+#include "zobrist.h"
+
+const char SELFPLAY_MAGIC[4] = {'T', 'T', 'S', 'P'};
+const uint32_t SELFPLAY_VERSION = 1;
+const uint8_t NO_CHILD = 255;
+
+const std::array<uint32_t, SELFPLAY_COLUMN_COUNT> SELFPLAY_COLUMN_WIDTHS = {
+    8, // COLUMN_GAME_ID
+    1, // COLUMN_PLY
+    NUM_SQUARES, // COLUMN_TILES
+    8, // COLUMN_VISITED
+    NUM_PLAYERS, // COLUMN_SQUARES
+    NUM_PLAYERS, // COLUMN_WEIGHTS
+    NUM_PLAYERS * 2, // COLUMN_SCORES
+    1, // COLUMN_ACTIVE_MASK
+    1, // COLUMN_TO_MOVE
+    1, // COLUMN_MOVE
+    8, // COLUMN_CHILD_MOVES
+    8 * 4, // COLUMN_CHILD_VISITS
+    NUM_PLAYERS * 2, // COLUMN_FINAL_SCORES
+    1, // COLUMN_WINNER_MASK
+};
+
+SelfPlayWriter::SelfPlayWriter(const std::string &path)
+    : file(std::fopen(path.c_str(), "ab")), rows(0) {}
+
+SelfPlayWriter::~SelfPlayWriter()
+{
+    if (file)
+        std::fclose(file);
+}
+
+void SelfPlayWriter::writeBlock(const std::array<std::vector<uint8_t>, SELFPLAY_COLUMN_COUNT> &columns, uint32_t rowCount)
+{
+    if (!file || rowCount == 0)
+        return;
+
+    uint32_t header[3] = {SELFPLAY_VERSION, rowCount, SELFPLAY_COLUMN_COUNT};
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::fwrite(SELFPLAY_MAGIC, 1, sizeof(SELFPLAY_MAGIC), file);
+    std::fwrite(header, sizeof(uint32_t), 3, file);
+    std::fwrite(SELFPLAY_COLUMN_WIDTHS.data(), sizeof(uint32_t), SELFPLAY_COLUMN_COUNT, file);
+
+    for (const std::vector<uint8_t> &column : columns)
+        std::fwrite(column.data(), 1, column.size(), file);
+
+    std::fflush(file);
+    rows += rowCount;
+}
+
+SelfPlayBuffer::SelfPlayBuffer(SelfPlayWriter &writer, uint32_t blockRows)
+    : writer(writer), blockRows(blockRows)
+{
+    for (int c = 0; c < SELFPLAY_COLUMN_COUNT; c++)
+        columns[c].reserve((size_t)blockRows * SELFPLAY_COLUMN_WIDTHS[c]);
+}
+
+SelfPlayBuffer::~SelfPlayBuffer()
+{
+    flush();
+}
+
+void SelfPlayBuffer::recordPosition(const GameState &state, uint64_t gameId, int move, const MctsResult *search)
+{
+    PendingRow row;
+
+    row.state = state;
+    row.gameId = gameId;
+    row.ply = (uint8_t)pending.size();
+    row.move = (uint8_t)move;
+    row.childMoves.fill(NO_CHILD);
+    row.childVisits.fill(0);
+
+    if (search)
+    {
+        for (int i = 0; i < search->childCount; i++)
+        {
+            row.childMoves[i] = search->childMoves[i];
+            row.childVisits[i] = (uint32_t)search->childVisits[i];
+        }
+    }
+
+    pending.push_back(row);
+}
+
+// appends the raw bytes of value to a column, the file is little-endian like the hosts it is written on
+template <typename T>
+static void appendColumn(std::vector<uint8_t> &column, const T &value)
+{
+    const uint8_t *bytes = (const uint8_t *)&value;
+    column.insert(column.end(), bytes, bytes + sizeof(T));
+}
+
+void SelfPlayBuffer::finishGame(const GameState &state)
+{
+    std::array<int16_t, NUM_PLAYERS> finalScores;
+
+    for (int player = 0; player < NUM_PLAYERS; player++)
+        finalScores[player] = state.pieces[player].score;
+
+    for (const PendingRow &row : pending)
+    {
+        const GameState &position = row.state;
+        std::array<uint8_t, NUM_PLAYERS> squares;
+        std::array<uint8_t, NUM_PLAYERS> weights;
+        std::array<int16_t, NUM_PLAYERS> scores;
+
+        for (int player = 0; player < NUM_PLAYERS; player++)
+        {
+            squares[player] = position.pieces[player].square;
+            weights[player] = position.pieces[player].currentWeight;
+            scores[player] = position.pieces[player].score;
+        }
+
+        appendColumn(columns[COLUMN_GAME_ID], row.gameId);
+        appendColumn(columns[COLUMN_PLY], row.ply);
+        appendColumn(columns[COLUMN_TILES], position.tiles);
+        appendColumn(columns[COLUMN_VISITED], position.visited);
+        appendColumn(columns[COLUMN_SQUARES], squares);
+        appendColumn(columns[COLUMN_WEIGHTS], weights);
+        appendColumn(columns[COLUMN_SCORES], scores);
+        appendColumn(columns[COLUMN_ACTIVE_MASK], position.activeMask);
+        appendColumn(columns[COLUMN_TO_MOVE], position.piecesIndex);
+        appendColumn(columns[COLUMN_MOVE], row.move);
+        appendColumn(columns[COLUMN_CHILD_MOVES], row.childMoves);
+        appendColumn(columns[COLUMN_CHILD_VISITS], row.childVisits);
+        appendColumn(columns[COLUMN_FINAL_SCORES], finalScores);
+        appendColumn(columns[COLUMN_WINNER_MASK], state.winnerMask);
+
+        if (++rowCount >= blockRows)
+            flush();
+    }
+
+    pending.clear();
+}
+
+void SelfPlayBuffer::flush()
+{
+    writer.writeBlock(columns, rowCount);
+    rowCount = 0;
+
+    for (std::vector<uint8_t> &column : columns)
+        column.clear();
+}
+
+// the most visited move, or one drawn in proportion to visits while ply < samplingPlies
+static int pickMove(const MctsResult &result, int ply, const SelfPlayConfig &config, uint64_t gameId)
+{
+    if (ply >= config.samplingPlies)
+        return result.bestMove;
+
+    int64_t total = 0;
+
+    for (int i = 0; i < result.childCount; i++)
+        total += result.childVisits[i];
+
+    if (total == 0)
+        return result.bestMove;
+
+    uint64_t draw = splitMix64(splitMix64(config.mcts.seed ^ (gameId << 8) ^ (uint64_t)ply));
+    int64_t pick = (int64_t)(draw % (uint64_t)total);
+
+    for (int i = 0; i < result.childCount; i++)
+    {
+        pick -= result.childVisits[i];
+
+        if (pick < 0)
+            return result.childMoves[i];
+    }
+
+    return result.bestMove;
+}
+
+void playSelfPlayGame(GameState &state, uint64_t gameId, const SelfPlayConfig &config, SelfPlayBuffer &buffer)
+{
+    MctsConfig mcts = config.mcts;
+    int ply = 0;
+
+    while (!state.isGameOver)
+    {
+        mcts.seed = splitMix64(config.mcts.seed ^ (gameId << 8) ^ (uint64_t)ply);
+
+        MctsResult result = searchMcts(state, mcts);
+        int move = pickMove(result, ply, config, gameId);
+
+        buffer.recordPosition(state, gameId, move, &result);
+        playMove(state, move);
+        ply++;
+    }
+
+    buffer.finishGame(state);
+}
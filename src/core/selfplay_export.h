@@ -0,0 +1,103 @@
+#pragma once
+
+#include "game_state.h"
+#include "mcts_bot.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// self-play positions in an append-only columnar file. The file is a run of blocks,
+// each one a header followed by every column of its rows stored contiguously:
+//
+//   char magic[4] "TTSP", uint32 version, uint32 rows, uint32 columns,
+//   uint32 width[columns] in bytes per row, then each column's rows * width bytes
+//
+// Columns are fixed width and little-endian, in the order of SelfPlayColumn. Equal
+// fields sit next to each other, so blocks compress well with any general compressor.
+enum SelfPlayColumn
+{
+    COLUMN_GAME_ID,      // uint64
+    COLUMN_PLY,          // uint8, moves played before this position
+    COLUMN_TILES,        // uint8[64], packed as in GameState
+    COLUMN_VISITED,      // uint64
+    COLUMN_SQUARES,      // uint8[4], by player
+    COLUMN_WEIGHTS,      // uint8[4]
+    COLUMN_SCORES,       // int16[4]
+    COLUMN_ACTIVE_MASK,  // uint8
+    COLUMN_TO_MOVE,      // uint8
+    COLUMN_MOVE,         // uint8, the square played
+    COLUMN_CHILD_MOVES,  // uint8[8], 255 past the last child
+    COLUMN_CHILD_VISITS, // uint32[8], search visits of each child
+    COLUMN_FINAL_SCORES, // int16[4], the game's result
+    COLUMN_WINNER_MASK,  // uint8
+    SELFPLAY_COLUMN_COUNT
+};
+
+extern const std::array<uint32_t, SELFPLAY_COLUMN_COUNT> SELFPLAY_COLUMN_WIDTHS;
+
+// shared by every thread, only takes a lock to append a finished block
+class SelfPlayWriter
+{
+public:
+    explicit SelfPlayWriter(const std::string &path);
+    ~SelfPlayWriter();
+
+    bool isOpen() const { return file != nullptr; }
+    int64_t rowsWritten() const { return rows.load(); }
+
+    // columns[c] holds rowCount * SELFPLAY_COLUMN_WIDTHS[c] bytes
+    void writeBlock(const std::array<std::vector<uint8_t>, SELFPLAY_COLUMN_COUNT> &columns, uint32_t rowCount);
+
+private:
+    FILE *file;
+    std::mutex mutex;
+    std::atomic<int64_t> rows;
+};
+
+// one per thread: rows of the game in progress wait here for the final score,
+// then go into columns that are handed to the writer a whole block at a time
+class SelfPlayBuffer
+{
+public:
+    explicit SelfPlayBuffer(SelfPlayWriter &writer, uint32_t blockRows = 4096);
+    ~SelfPlayBuffer();
+
+    // the position before move, with the search's child visits if there was a search
+    void recordPosition(const GameState &state, uint64_t gameId, int move, const MctsResult *search);
+
+    // labels the recorded positions with the finished game's result
+    void finishGame(const GameState &state);
+
+    void flush();
+
+private:
+    struct PendingRow
+    {
+        GameState state;
+        uint64_t gameId;
+        uint8_t ply;
+        uint8_t move;
+        std::array<uint8_t, 8> childMoves;
+        std::array<uint32_t, 8> childVisits;
+    };
+
+    SelfPlayWriter &writer;
+    uint32_t blockRows;
+    uint32_t rowCount = 0;
+    std::vector<PendingRow> pending;
+    std::array<std::vector<uint8_t>, SELFPLAY_COLUMN_COUNT> columns;
+};
+
+struct SelfPlayConfig
+{
+    MctsConfig mcts;
+    int samplingPlies = 8; // early moves drawn in proportion to visits, for varied games
+};
+
+// plays one game from state with MCTS in every seat, recording every position
+void playSelfPlayGame(GameState &state, uint64_t gameId, const SelfPlayConfig &config, SelfPlayBuffer &buffer);
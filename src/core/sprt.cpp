@@ -0,0 +1,62 @@
+#include "sprt.h"
+
+#include <cmath>
+
+// the variance estimate is too rough to act on before this many samples
+const int64_t SPRT_MIN_SAMPLES = 16;
+
+// below this the variance is rounding left over from identical samples, not spread
+const double SPRT_MIN_VARIANCE = 1e-12;
+
+Sprt::Sprt(const SprtConfig &config)
+    : config(config),
+      lower(std::log(config.beta / (1.0 - config.alpha))),
+      upper(std::log((1.0 - config.beta) / config.alpha)) {}
+
+void Sprt::addSample(double sample)
+{
+    count++;
+    sum += sample;
+    sumOfSquares += sample * sample;
+}
+
+static double sampleVariance(int64_t count, double sum, double sumOfSquares)
+{
+    if (count < 2)
+        return 0.0;
+
+    double average = sum / count;
+    double variance = sumOfSquares / count - average * average;
+    return variance > SPRT_MIN_VARIANCE ? variance : 0.0;
+}
+
+bool Sprt::hasVariance() const
+{
+    return sampleVariance(count, sum, sumOfSquares) > 0.0;
+}
+
+double Sprt::llr() const
+{
+    double variance = sampleVariance(count, sum, sumOfSquares);
+
+    if (variance == 0.0)
+        return 0.0;
+
+    return (config.mu1 - config.mu0) / variance * (sum - count * (config.mu0 + config.mu1) / 2.0);
+}
+
+SprtStatus Sprt::status() const
+{
+    if (count < SPRT_MIN_SAMPLES)
+        return SprtStatus::Continue;
+
+    double ratio = llr();
+
+    if (ratio >= upper)
+        return SprtStatus::AcceptH1;
+
+    if (ratio <= lower)
+        return SprtStatus::AcceptH0;
+
+    return SprtStatus::Continue;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+// sequential probability ratio test on the mean of a stream of samples, such as a
+// new bot's per-board win share minus the old bot's. H0 says the mean is mu0, H1
+// says it is mu1, and the test stops as soon as the evidence favours one of them
+// at the requested error rates. Uses the normal approximation of the log likelihood
+// ratio with the sample variance, as the samples are bounded but not binary.
+struct SprtConfig
+{
+    double mu0 = 0.0;
+    double mu1 = 0.02;
+    double alpha = 0.05; // chance of accepting H1 when H0 holds, strictly between 0 and 1
+    double beta = 0.05;  // chance of accepting H0 when H1 holds, strictly between 0 and 1
+};
+
+enum class SprtStatus
+{
+    Continue,
+    AcceptH0,
+    AcceptH1
+};
+
+class Sprt
+{
+public:
+    explicit Sprt(const SprtConfig &config);
+
+    void addSample(double sample);
+
+    double llr() const;
+    double lowerBound() const { return lower; }
+    double upperBound() const { return upper; }
+    SprtStatus status() const;
+
+    int64_t sampleCount() const { return count; }
+    double mean() const { return count > 0 ? sum / count : 0.0; }
+
+    // false while every sample so far is the same, the llr stays 0 and no verdict can come
+    bool hasVariance() const;
+
+private:
+    SprtConfig config;
+    double lower;
+    double upper;
+    int64_t count = 0;
+    double sum = 0.0;
+    double sumOfSquares = 0.0;
+};
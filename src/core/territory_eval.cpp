@@ -0,0 +1,100 @@
+#include "territory_eval.h"
+#include "move_gen.h"
+
+#include <algorithm>
+
+// the best positive tiles by points per unit of weight, whole tiles only,
+// a quick estimate of what the piece can still collect in its territory
+static void fillCapacity(const GameState &state, uint64_t squares, int remaining, int &value, int &weight)
+{
+    // tile counts by the stored value nibble and weight
+    std::array<std::array<int, MAX_TILE_WEIGHT + 1>, 16> counts = {};
+
+    while (squares)
+    {
+        int square = popLowestSquare(squares);
+        if (tileValue(state, square) > 0)
+            counts[state.tiles[square] & 0xF][tileWeight(state, square)]++;
+    }
+
+    value = 0;
+    weight = 0;
+
+    // pick from each value and weight pair in falling order of value per weight
+    while (remaining > 0)
+    {
+        int bestValue = 0;
+        int bestWeight = 1;
+        int bestRow = -1;
+
+        for (int row = VALUE_BIAS + 1; row < 16; row++)
+        {
+            for (int w = 1; w <= std::min(remaining, MAX_TILE_WEIGHT); w++)
+            {
+                int v = row - VALUE_BIAS;
+
+                if (counts[row][w] > 0 && v * bestWeight > bestValue * w)
+                {
+                    bestValue = v;
+                    bestWeight = w;
+                    bestRow = row;
+                }
+            }
+        }
+
+        if (bestRow < 0)
+            break;
+
+        int taken = std::min(counts[bestRow][bestWeight], remaining / bestWeight);
+
+        counts[bestRow][bestWeight] = 0;
+        value += taken * bestValue;
+        weight += taken * bestWeight;
+        remaining -= taken * bestWeight;
+    }
+}
+
+Territory computeTerritory(const GameState &state)
+{
+    Territory territory;
+    std::array<uint64_t, NUM_PLAYERS> open = {};
+    std::array<uint64_t, NUM_PLAYERS> frontier = {};
+    uint64_t claimed = state.visited;
+    bool growing = false;
+
+    for (int player = 0; player < NUM_PLAYERS; player++)
+    {
+        if (!isActive(state, player))
+            continue;
+
+        open[player] = ~state.visited & weightFeasibleMask(state, player);
+        frontier[player] = squareBit(state.pieces[player].square);
+        growing = true;
+    }
+
+    while (growing)
+    {
+        growing = false;
+
+        for (int i = 0; i < NUM_PLAYERS; i++)
+        {
+            int player = (state.piecesIndex + i) % NUM_PLAYERS;
+
+            if (!frontier[player])
+                continue;
+
+            frontier[player] = kingDilate(frontier[player]) & open[player] & ~claimed;
+            claimed |= frontier[player];
+            territory.squares[player] |= frontier[player];
+            growing |= frontier[player] != 0;
+        }
+    }
+
+    for (int player = 0; player < NUM_PLAYERS; player++)
+    {
+        int remaining = MAX_WEIGHT - state.pieces[player].currentWeight;
+        fillCapacity(state, territory.squares[player], remaining, territory.value[player], territory.weight[player]);
+    }
+
+    return territory;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "game_state.h"
+
+#include <array>
+#include <cstdint>
+
+// the unvisited squares each piece reaches before any other piece, found with a
+// simultaneous breadth-first fill. Pieces step in turn order, so on equal distance
+// the piece that moves sooner claims the square.
+struct Territory
+{
+    std::array<uint64_t, NUM_PLAYERS> squares = {};
+    std::array<int, NUM_PLAYERS> value = {};  // points of the best tiles that fit in the remaining capacity
+    std::array<int, NUM_PLAYERS> weight = {}; // weight of those tiles
+};
+
+Territory computeTerritory(const GameState &state);
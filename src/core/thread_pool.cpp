@@ -0,0 +1,109 @@
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(int threads) : nextQueue(0)
+{
+    if (threads < 1)
+        threads = 1;
+
+    for (int i = 0; i < threads; i++)
+        queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+
+    for (int i = 0; i < threads; i++)
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    wake.notify_all();
+
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    WorkQueue &queue = *queues[nextQueue++ % queues.size()];
+
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued++;
+        unfinished++;
+    }
+
+    wake.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]() { return unfinished == 0; });
+}
+
+// own queue from the back, then the other queues from the front
+bool ThreadPool::popTask(int worker, std::function<void()> &task)
+{
+    for (size_t i = 0; i < queues.size(); i++)
+    {
+        WorkQueue &queue = *queues[(worker + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.tasks.empty())
+            continue;
+
+        if (i == 0)
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+void ThreadPool::workerLoop(int worker)
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return stopping || queued > 0; });
+
+            if (queued == 0)
+                return;
+
+            queued--;
+        }
+
+        // queued counts tasks no worker has claimed yet, so a task is always there to pop
+        std::function<void()> task;
+
+        while (!popTask(worker, task))
+            std::this_thread::yield();
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (--unfinished == 0)
+                idle.notify_all();
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// fixed set of workers, each with its own task queue. A worker runs its newest task
+// first and, once its queue is empty, steals the oldest task of another worker,
+// so uneven tasks such as games of different lengths still keep every core busy.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(int threads);
+    ~ThreadPool();
+
+    // queues task on the workers in turn
+    void submit(std::function<void()> task);
+
+    // blocks until every submitted task has finished
+    void wait();
+
+    int threadCount() const { return (int)workers.size(); }
+
+private:
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool popTask(int worker, std::function<void()> &task);
+    void workerLoop(int worker);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> nextQueue;
+
+    // sleeping workers and wait() are woken through here
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    size_t queued = 0;
+    size_t unfinished = 0;
+    bool stopping = false;
+};
@@ -0,0 +1,119 @@
+#include "transposition_table.h"
+
+// data word layout: value in bits 0-31, depth 32-39, bound 40-41, move 42-48, generation 56-63
+static uint64_t packData(const TTData &data, uint8_t generation)
+{
+    uint64_t move = data.bestMove < 0 ? 0x7F : (uint64_t)data.bestMove;
+
+    return (uint64_t)(uint32_t)data.value |
+           (uint64_t)(uint8_t)data.depth << 32 |
+           (uint64_t)data.bound << 40 |
+           move << 42 |
+           (uint64_t)generation << 56;
+}
+
+static TTData unpackData(uint64_t word)
+{
+    TTData data;
+    int move = (int)((word >> 42) & 0x7F);
+
+    data.value = (int32_t)(uint32_t)word;
+    data.depth = (int)((word >> 32) & 0xFF);
+    data.bound = (BoundType)((word >> 40) & 0x3);
+    data.bestMove = move == 0x7F ? -1 : move;
+    return data;
+}
+
+static uint8_t dataGeneration(uint64_t word) { return (uint8_t)(word >> 56); }
+static int dataDepth(uint64_t word) { return (int)((word >> 32) & 0xFF); }
+
+TranspositionTable::TranspositionTable(size_t megabytes)
+    : generation(0)
+{
+    size_t count = 1;
+
+    while (count * 2 * sizeof(Bucket) <= megabytes * 1024 * 1024)
+        count *= 2;
+
+    buckets.reset(new Bucket[count]);
+    mask = count - 1;
+    clear();
+}
+
+// not safe to call while searches are running
+void TranspositionTable::clear()
+{
+    for (size_t i = 0; i <= mask; i++)
+    {
+        for (Entry &entry : buckets[i].entries)
+        {
+            entry.check.store(0, std::memory_order_relaxed);
+            entry.data.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    generation.store(0, std::memory_order_relaxed);
+}
+
+// entries from earlier searches become the first to be replaced
+void TranspositionTable::newSearch()
+{
+    generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool TranspositionTable::probe(uint64_t key, TTData &data) const
+{
+    const Bucket &bucket = buckets[key & mask];
+
+    for (const Entry &entry : bucket.entries)
+    {
+        uint64_t word = entry.data.load(std::memory_order_relaxed);
+
+        if ((entry.check.load(std::memory_order_relaxed) ^ word) == key && word != 0)
+        {
+            data = unpackData(word);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, const TTData &data)
+{
+    Bucket &bucket = buckets[key & mask];
+    uint8_t currentGeneration = generation.load(std::memory_order_relaxed);
+    Entry *victim = &bucket.entries[0];
+    int victimScore = 1 << 30;
+
+    for (Entry &entry : bucket.entries)
+    {
+        uint64_t word = entry.data.load(std::memory_order_relaxed);
+
+        if ((entry.check.load(std::memory_order_relaxed) ^ word) == key)
+        {
+            // keep a deeper result for the same position unless this one is exact
+            if (data.depth < dataDepth(word) && data.bound != BoundType::Exact &&
+                dataGeneration(word) == currentGeneration)
+                return;
+
+            victim = &entry;
+            break;
+        }
+
+        // prefer to replace shallow entries and entries left over from old searches
+        int age = (uint8_t)(currentGeneration - dataGeneration(word));
+        int score = dataDepth(word) - 8 * age;
+
+        if (score < victimScore)
+        {
+            victimScore = score;
+            victim = &entry;
+        }
+    }
+
+    uint64_t word = packData(data, currentGeneration);
+
+    victim->check.store(key ^ word, std::memory_order_relaxed);
+    victim->data.store(word, std::memory_order_relaxed);
+}
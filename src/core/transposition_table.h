@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+enum class BoundType : uint8_t
+{
+    None, // only the best move is known
+    Exact,
+    Lower,
+    Upper
+};
+
+// depth stored for subtrees that were searched all the way to the end of the game
+const int RESOLVED_DEPTH = 255;
+
+struct TTData
+{
+    int value = 0;
+    int depth = 0;
+    BoundType bound = BoundType::None;
+    int bestMove = -1;
+};
+
+// fixed-size table shared by any number of search threads without locks. Each
+// entry is two 64-bit words, the packed data and the key xor the data, so a torn
+// write from a racing thread fails the key check instead of returning bad data.
+class TranspositionTable
+{
+public:
+    explicit TranspositionTable(size_t megabytes = 16);
+
+    void clear();
+    void newSearch();
+
+    bool probe(uint64_t key, TTData &data) const;
+    void store(uint64_t key, const TTData &data);
+
+    size_t bucketCount() const { return mask + 1; }
+
+private:
+    static const int ENTRIES_PER_BUCKET = 4;
+
+    struct Entry
+    {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+
+    struct alignas(64) Bucket
+    {
+        Entry entries[ENTRIES_PER_BUCKET];
+    };
+
+    std::unique_ptr<Bucket[]> buckets;
+    size_t mask;
+    std::atomic<uint8_t> generation;
+};
@@ -0,0 +1,36 @@
+#include "zobrist.h"
+#include "bitboard.h"
+
+#include <cstring>
+
+uint64_t computeBoardKey(const GameState &state)
+{
+    uint64_t key = 0;
+
+    for (int i = 0; i < NUM_SQUARES; i += 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, &state.tiles[i], sizeof(word));
+        key = splitMix64(key ^ word);
+    }
+
+    return key;
+}
+
+uint64_t computeHash(const GameState &state)
+{
+    uint64_t hash = state.boardKey ^ PLAYER_TO_MOVE_KEYS[state.piecesIndex];
+
+    for (uint64_t visited = state.visited; visited;)
+        hash ^= VISITED_KEYS[popLowestSquare(visited)];
+
+    for (int player = 0; player < NUM_PLAYERS; player++)
+    {
+        hash ^= pieceKey(player, state.pieces[player]);
+
+        if (isActive(state, player))
+            hash ^= ACTIVE_KEYS[player];
+    }
+
+    return hash;
+}
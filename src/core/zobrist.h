@@ -0,0 +1,53 @@
+#pragma once
+
+#include "game_state.h"
+
+#include <array>
+#include <cstdint>
+
+constexpr uint64_t splitMix64(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+template <int N>
+constexpr std::array<uint64_t, N> makeZobristKeys(uint64_t seed)
+{
+    std::array<uint64_t, N> keys = {};
+
+    for (int i = 0; i < N; i++)
+        keys[i] = splitMix64(seed + (uint64_t)i * 0x632BE59BD9B4E019ULL);
+
+    return keys;
+}
+
+constexpr std::array<uint64_t, NUM_SQUARES> VISITED_KEYS = makeZobristKeys<NUM_SQUARES>(1);
+constexpr std::array<uint64_t, NUM_PLAYERS * NUM_SQUARES> PIECE_SQUARE_KEYS = makeZobristKeys<NUM_PLAYERS * NUM_SQUARES>(2);
+constexpr std::array<uint64_t, NUM_PLAYERS> PLAYER_TO_MOVE_KEYS = makeZobristKeys<NUM_PLAYERS>(3);
+constexpr std::array<uint64_t, NUM_PLAYERS> ACTIVE_KEYS = makeZobristKeys<NUM_PLAYERS>(4);
+
+// not part of the position, searches mix these in so values from different viewpoints never mix
+constexpr std::array<uint64_t, NUM_PLAYERS> ROOT_PLAYER_KEYS = makeZobristKeys<NUM_PLAYERS>(5);
+constexpr uint64_t MAXN_SEARCH_KEY = splitMix64(6);
+constexpr std::array<uint64_t, 3> EVALUATION_KEYS = {0, splitMix64(7), splitMix64(8)}; // by Evaluation
+
+// weight and score are hashed from their value rather than a table, scores have no tight range
+inline uint64_t pieceTallyKey(int player, int weight, int score)
+{
+    return splitMix64(0xA24BAED4963EE407ULL ^ ((uint64_t)player << 40) ^ ((uint64_t)weight << 24) ^ (uint16_t)score);
+}
+
+inline uint64_t pieceKey(int player, const PieceState &piece)
+{
+    return PIECE_SQUARE_KEYS[player * NUM_SQUARES + piece.square] ^
+           pieceTallyKey(player, piece.currentWeight, piece.score);
+}
+
+// mixes the tiles into one key so positions on different boards never collide
+uint64_t computeBoardKey(const GameState &state);
+
+// the full hash from scratch, movePiece and makeMove keep state.hash in step incrementally
+uint64_t computeHash(const GameState &state);
@@ -1,21 +1,19 @@
 #include "include/raylib.h"
 #include "include/raymath.h"
+#include "game_state.h"
+#include "bot.h"
+#include "cpu_worker.h"
 #include <iostream>
 #include <vector>
 #include <array>
 #include <string>
-#include <algorithm>
-#include <random>
-#include <chrono>
 
 const int SCREEN_WIDTH = 1200;
 const int SCREEN_HEIGHT = 800;
-const int BOARD_SIZE = 8;
 const int SQUARE_SIZE = 70;
 const int BORDER_WIDTH = 1;
 const int FRAME_THICKNESS = 3;
 const int BOARD_OFFSET = (SCREEN_WIDTH - (BOARD_SIZE * SQUARE_SIZE) - 500) / 2;
-const int MAX_WEIGHT = 24;
 const int TABLE_WIDTH = 350;
 const int TABLE_HEIGHT = 560;
 
@@ -23,39 +21,21 @@ const int TABLE_HEIGHT = 560;
 int startX = BOARD_OFFSET + 20;
 int startY = BOARD_OFFSET + 40;
 
-struct BoardSquare
-{
-    int height = SQUARE_SIZE;
-    int width = SQUARE_SIZE;
-    int row;
-    int col;
-    int posX;
-    int posY;
-    int value;
-    int weight;
-    bool visited;
-    Color color;
-};
+int squarePosX(int col) { return startX + (col * SQUARE_SIZE); }
+int squarePosY(int row) { return startY + (row * SQUARE_SIZE); }
 
+// render-only data for a seat, the rules data lives in game.pieces
 struct GamePiece
 {
     int id;
-    int row;
-    int col;
     float radius;
     Color color;
-    int capacity;
-    int currentWeight;
-    int score;
     bool isComputer;
-    bool isCurrentPlayer;
-    bool isActive;
-    bool isWinner;
 
-    Vector2 getPosition(const BoardSquare &square) const
+    Vector2 getPosition(const PieceState &state) const
     {
-        return {square.posX + square.width / 2.0f,
-                square.posY + square.height / 2.0f};
+        return {squarePosX(squareCol(state.square)) + SQUARE_SIZE / 2.0f,
+                squarePosY(squareRow(state.square)) + SQUARE_SIZE / 2.0f};
     }
 };
 
@@ -71,15 +51,12 @@ struct PlayerTablePositions
     int playerCurrentSquareOffsetY;
 };
 
-std::vector<int> values = {-4, -2, 2, 4, 6, 8};
-std::vector<int> weights = {1, 2, 3, 4};
-
-std::vector<std::vector<BoardSquare>> board(BOARD_SIZE, std::vector<BoardSquare>(BOARD_SIZE));
+GameState game;
 std::vector<GamePiece> pieces;
-int piecesIndex = 0;
 
-const std::array<int, 8> DIRECTION_ROWS_8 = {-1, -1, -1, 0, 0, 1, 1, 1};
-const std::array<int, 8> DIRECTION_COLS_8 = {-1, 0, 1, -1, 1, -1, 0, 1};
+// CPU seats think on a worker thread, the table must outlive any search it runs
+TranspositionTable cpuTable(16);
+CpuWorker cpuWorker;
 
 PlayerTablePositions p1Positions = {190, 25, 175, 65, 175, 90, 175, 115};
 PlayerTablePositions p2Positions = {190, 150, 175, 190, 175, 215, 175, 240};
@@ -88,37 +65,24 @@ PlayerTablePositions p4Positions = {190, 400, 175, 440, 175, 465, 175, 490};
 
 GamePiece *selectedPiece = nullptr;
 bool dragging = false;
-bool isGameOver;
-bool isTie;
 
 // function forward declarations
-std::vector<int> createIntVector(std::vector<int> &vector, int numOfInstances);
-void randomizeVector(std::vector<int> &vector);
-void fillBoard(std::vector<std::vector<BoardSquare>> &board, std::vector<int> &valuesVec, std::vector<int> &weightsVec);
 void initializeBoard();
 
 void handleMouseInput(GamePiece &piece);
-void makeCPUMove(GamePiece &piece);
-std::pair<int, int> getBestMoveCoords(std::vector<std::pair<int, int>> legalMoves);
-bool movePiece(GamePiece &piece, std::vector<std::vector<BoardSquare>> &board, int newRow, int newCol);
-void finishTurn();
-int checkRemainingMoves(GamePiece &piece, std::vector<std::vector<BoardSquare>> &board, int row, int col);
-bool checkGameOver();
-void setWinner();
-int countWinner();
 void resetGame();
 
 void drawSquareText(int boardSquareInt, int row, int col,
                     int fontSize, int posX, int posY, int yOffset);
-void drawBoard(std::vector<std::vector<BoardSquare>> &board);
+void drawBoard(const GameState &state);
 void drawBoardFrame();
 
 void drawGameTable();
-void drawPlayerInformation(std::string player, PlayerTablePositions &playerPositions, GamePiece &piece);
+void drawPlayerInformation(std::string player, PlayerTablePositions &playerPositions, int playerIndex);
 void drawNewGameButton();
 
 void addOutline(Vector2 position, GamePiece &piece);
-void drawPiece(GamePiece &piece, std::vector<std::vector<BoardSquare>> &board);
+void drawPiece(GamePiece &piece, const PieceState &state);
 void drawDraggingPiece();
 
 int main()
@@ -128,44 +92,50 @@ int main()
 
     initializeBoard();
 
-    bool cpuThinking = false;
-    double cpuStartTime = 0.0;
     double cpuDelay = 0.5;
 
+    BotConfig cpuBot;
+    cpuBot.search.timeBudget = cpuDelay;
+    cpuBot.search.table = &cpuTable;
+    cpuBot.mcts.timeBudget = cpuDelay;
+
     while (!WindowShouldClose())
     {
-        if (!isGameOver)
+        if (!game.isGameOver)
         {
-            GamePiece &current = pieces[piecesIndex];
+            GamePiece &current = pieces[game.piecesIndex];
 
-            if (current.isCurrentPlayer && !current.isComputer)
+            if (!current.isComputer)
             {
+                // the CPU seats think about their replies while the human decides
+                if (!cpuWorker.isPondering())
+                    cpuWorker.ponder(game, cpuBot);
+
                 handleMouseInput(current);
             }
             else
             {
-                if (!cpuThinking)
+                int cpuMove;
+
+                if (!cpuWorker.isThinking())
                 {
-                    cpuThinking = true;
-                    cpuStartTime = GetTime();
+                    cpuWorker.start(game, cpuBot, cpuDelay);
                 }
-                else
+                else if (cpuWorker.poll(cpuMove))
                 {
-                    if (GetTime() - cpuStartTime >= cpuDelay)
-                    {
-                        makeCPUMove(current);
-                        finishTurn();
-
-                        cpuThinking = false;
-                    }
+                    applyMove(game, cpuMove);
                 }
             }
         }
+        else if (cpuWorker.isPondering())
+        {
+            cpuWorker.cancel();
+        }
 
         BeginDrawing();
         ClearBackground(RAYWHITE);
 
-        drawBoard(board);
+        drawBoard(game);
         drawBoardFrame();
         drawGameTable();
 
@@ -174,90 +144,20 @@ int main()
         EndDrawing();
     }
 
+    cpuWorker.cancel();
     CloseWindow();
 
     return 0;
 }
 
-std::vector<int> createIntVector(std::vector<int> &vector, int numOfInstances)
-{
-    std::vector<int> intVector;
-
-    for (int i : vector)
-    {
-        for (int j = 0; j < numOfInstances; j++)
-        {
-            intVector.push_back(i);
-        }
-    }
-
-    return intVector;
-}
-
-void randomizeVector(std::vector<int> &vector)
-{
-    unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-    std::default_random_engine generator(seed);
-    std::shuffle(vector.begin(), vector.end(), generator);
-}
-
-void fillBoard(std::vector<std::vector<BoardSquare>> &board,
-               std::vector<int> &valuesVec,
-               std::vector<int> &weightsVec)
-{
-    int vectorIndex = 0;
-
-    // fill board with random values and weights
-    for (int row = 0; row < BOARD_SIZE; row++)
-    {
-        for (int col = 0; col < BOARD_SIZE; col++)
-        {
-            if ((row == 1 && col == 1) ||
-                (row == 1 && col == 6) ||
-                (row == 6 && col == 1) ||
-                (row == 6 && col == 6))
-            {
-                board[row][col].visited = true;
-                board[row][col].color = BEIGE;
-
-                int posX = startX + (col * SQUARE_SIZE);
-                int posY = startY + (row * SQUARE_SIZE);
-
-                board[row][col].posX = posX;
-                board[row][col].posY = posY;
-                continue;
-            }
-
-            int posX = startX + (col * SQUARE_SIZE);
-            int posY = startY + (row * SQUARE_SIZE);
-
-            board[row][col].posX = posX;
-            board[row][col].posY = posY;
-            board[row][col].row = row;
-            board[row][col].col = col;
-            board[row][col].value = valuesVec[vectorIndex];
-            board[row][col].weight = weightsVec[vectorIndex];
-            board[row][col].visited = false;
-            board[row][col].color = BEIGE;
-
-            vectorIndex++;
-        }
-    }
-}
-
 void initializeBoard()
 {
-    std::vector<int> valuesVector = createIntVector(values, 10);
-    std::vector<int> weightsVector = createIntVector(weights, 15);
-    randomizeVector(valuesVector);
-    randomizeVector(weightsVector);
-
-    fillBoard(board, valuesVector, weightsVector);
+    initializeRandomGame(game);
 
-    pieces.push_back({1, 1, 1, 25.0f, RED, MAX_WEIGHT, 0, 0, false, true, true, false});    // player 1
-    pieces.push_back({2, 1, 6, 25.0f, GREEN, MAX_WEIGHT, 0, 0, true, false, true, false});  // player 2
-    pieces.push_back({3, 6, 1, 25.0f, BLUE, MAX_WEIGHT, 0, 0, true, false, true, false});   // player 3
-    pieces.push_back({4, 6, 6, 25.0f, YELLOW, MAX_WEIGHT, 0, 0, true, false, true, false}); // player 4
+    pieces.push_back({1, 25.0f, RED, false});   // player 1
+    pieces.push_back({2, 25.0f, GREEN, true});  // player 2
+    pieces.push_back({3, 25.0f, BLUE, true});   // player 3
+    pieces.push_back({4, 25.0f, YELLOW, true}); // player 4
 }
 
 void handleMouseInput(GamePiece &piece)
@@ -265,9 +165,9 @@ void handleMouseInput(GamePiece &piece)
     if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
     {
         Vector2 mouse = GetMousePosition();
-        Vector2 piecePos = piece.getPosition(board[piece.row][piece.col]);
+        Vector2 piecePos = piece.getPosition(game.pieces[game.piecesIndex]);
 
-        if (piece.isCurrentPlayer && CheckCollisionPointCircle(mouse, piecePos, piece.radius))
+        if (CheckCollisionPointCircle(mouse, piecePos, piece.radius))
         {
             selectedPiece = &piece;
             dragging = true;
@@ -282,26 +182,14 @@ void handleMouseInput(GamePiece &piece)
         {
             for (int c = 0; c < BOARD_SIZE; c++)
             {
-                BoardSquare &sq = board[r][c];
-
-                Rectangle rect = {(float)sq.posX,
-                                  (float)sq.posY,
-                                  (float)sq.width,
-                                  (float)sq.height};
+                Rectangle rect = {(float)squarePosX(c),
+                                  (float)squarePosY(r),
+                                  (float)SQUARE_SIZE,
+                                  (float)SQUARE_SIZE};
 
                 if (CheckCollisionPointRec(mouse, rect))
                 {
-                    bool isMovable = movePiece(*selectedPiece, board, r, c);
-
-                    if (isMovable)
-                    {
-                        int remainingMoves = checkRemainingMoves(*selectedPiece, board, r, c);
-
-                        if (remainingMoves == 0)
-                            selectedPiece->isActive = false;
-
-                        finishTurn();
-                    }
+                    applyMove(game, squareIndex(r, c));
                     selectedPiece = nullptr;
                     dragging = false;
                     return;
@@ -311,199 +199,11 @@ void handleMouseInput(GamePiece &piece)
     }
 }
 
-std::pair<int, int> getBestMoveCoords(std::vector<std::pair<int, int>> legalMoves)
-{
-    int maxValue = -10;
-    int minWeight = 5;
-    std::pair<int, int> bestMoveCoords;
-
-    for (auto pair : legalMoves)
-    {
-        int boardValue = board[pair.first][pair.second].value;
-        int boardWeight = board[pair.first][pair.second].weight;
-
-        if (boardValue == maxValue && boardWeight <= minWeight)
-        {
-            minWeight = boardWeight;
-            bestMoveCoords = {pair.first, pair.second};
-        }
-        else if (boardValue > maxValue)
-        {
-            maxValue = boardValue;
-            minWeight = boardWeight;
-            bestMoveCoords = {pair.first, pair.second};
-        }
-    }
-
-    return bestMoveCoords;
-}
-
-void makeCPUMove(GamePiece &piece)
-{
-    std::vector<std::pair<int, int>> legalMoves;
-    for (int i = 0; i < 8; i++)
-    {
-        int destRow = piece.row + DIRECTION_ROWS_8[i];
-        int destCol = piece.col + DIRECTION_COLS_8[i];
-
-        if (destRow >= 0 && destRow < BOARD_SIZE &&
-            destCol >= 0 && destCol < BOARD_SIZE &&
-            board[destRow][destCol].weight + piece.currentWeight <= piece.capacity &&
-            !board[destRow][destCol].visited)
-            legalMoves.push_back({destRow, destCol});
-    }
-
-    if (legalMoves.empty())
-    {
-        piece.isActive = false;
-        return;
-    }
-
-    auto bestVal = getBestMoveCoords(legalMoves);
-
-    // int choice = (legalMoves.size() == 1) ? 0 : GetRandomValue(0, legalMoves.size() - 1);
-    // auto [newRow, newCol] = legalMoves[choice];
-    int newRow = bestVal.first;
-    int newCol = bestVal.second;
-
-    bool isMovable = movePiece(piece, board, newRow, newCol);
-
-    if (isMovable)
-    {
-        int remainingMoves = checkRemainingMoves(piece, board, newRow, newCol);
-
-        if (remainingMoves == 0)
-            piece.isActive = false;
-    }
-}
-
-bool movePiece(GamePiece &piece, std::vector<std::vector<BoardSquare>> &board, int newRow, int newCol)
-{
-    BoardSquare &destSquare = board[newRow][newCol];
-
-    if (!piece.isActive || !piece.isCurrentPlayer || destSquare.visited ||
-        std::max(abs(newRow - piece.row), abs(newCol - piece.col)) != 1)
-        return false;
-
-    if (!destSquare.visited && (piece.currentWeight + destSquare.weight <= piece.capacity))
-    {
-        piece.currentWeight += destSquare.weight;
-        piece.score += destSquare.value;
-        destSquare.visited = true;
-        destSquare.color = piece.color;
-        piece.row = newRow;
-        piece.col = newCol;
-        return true;
-    }
-
-    return false;
-}
-
-void finishTurn()
-{
-    pieces[piecesIndex].isCurrentPlayer = false;
-
-    isGameOver = checkGameOver();
-
-    if (isGameOver)
-    {
-        setWinner();
-        int winnerCount = countWinner();
-
-        if (winnerCount > 1)
-            isTie = true;
-
-        return;
-    }
-
-    do
-    {
-        piecesIndex = (piecesIndex + 1) % pieces.size();
-
-    } while (pieces[piecesIndex].isActive == false);
-
-    pieces[piecesIndex].isCurrentPlayer = true;
-}
-
-int checkRemainingMoves(GamePiece &piece, std::vector<std::vector<BoardSquare>> &board, int row, int col)
-{
-    int remainingMoves = 0;
-
-    for (int i = 0; i < 8; i++)
-    {
-        int destRow = row + DIRECTION_ROWS_8[i];
-        int destCol = col + DIRECTION_COLS_8[i];
-
-        if (destRow >= 0 && destRow < BOARD_SIZE &&
-            destCol >= 0 && destCol < BOARD_SIZE &&
-            board[destRow][destCol].weight + piece.currentWeight <= piece.capacity &&
-            !board[destRow][destCol].visited)
-        {
-            remainingMoves += 1;
-        }
-    }
-
-    return remainingMoves;
-}
-
-bool checkGameOver()
-{
-    for (const auto &piece : pieces)
-    {
-        if (piece.isActive)
-            return false;
-    }
-
-    return true;
-}
-
-void setWinner()
-{
-    int maxValue = std::max_element(pieces.begin(), pieces.end(),
-                                    [](const GamePiece &a, const GamePiece &b)
-                                    {
-                                        return a.score < b.score;
-                                    })
-                       ->score;
-
-    int minWeight = std::min_element(pieces.begin(), pieces.end(),
-                                     [maxValue](const GamePiece &a, const GamePiece &b)
-                                     {
-                                         if (a.score != maxValue && b.score != maxValue)
-                                             return false;
-                                         if (a.score != maxValue)
-                                             return false;
-                                         if (b.score != maxValue)
-                                             return true;
-                                         return a.currentWeight < b.currentWeight;
-                                     })
-                        ->currentWeight;
-
-    for (GamePiece &p : pieces)
-    {
-        if (p.score == maxValue && p.currentWeight == minWeight)
-            p.isWinner = true;
-    }
-}
-
-int countWinner()
-{
-    int winnerCount = std::count_if(pieces.begin(), pieces.end(),
-                                    [](const GamePiece &p)
-                                    {
-                                        return p.isWinner;
-                                    });
-
-    return winnerCount;
-}
-
 void resetGame()
 {
+    cpuWorker.cancel();
     selectedPiece = nullptr;
     dragging = false;
-    isGameOver = false;
-    isTie = false;
-    piecesIndex = 0;
     pieces.clear();
     initializeBoard();
 }
@@ -512,10 +212,7 @@ void drawSquareText(int boardSquareInt, int row, int col,
                     int fontSize, int posX, int posY, int yOffset)
 {
     std::string valueText = std::to_string(boardSquareInt);
-    if ((row == 1 && col == 1) ||
-        (row == 1 && col == 6) ||
-        (row == 6 && col == 1) ||
-        (row == 6 && col == 6))
+    if (isStartSquare(row, col))
         valueText = "";
     int valueTextWidth = MeasureText(valueText.c_str(), fontSize);
     int valueTextX = posX + (SQUARE_SIZE / 2) - (valueTextWidth / 2);
@@ -523,27 +220,29 @@ void drawSquareText(int boardSquareInt, int row, int col,
     DrawText(valueText.c_str(), valueTextX, valueTextY, fontSize, BLACK);
 }
 
-void drawBoard(std::vector<std::vector<BoardSquare>> &board)
+void drawBoard(const GameState &state)
 {
     for (int row = 0; row < BOARD_SIZE; row++)
     {
         for (int col = 0; col < BOARD_SIZE; col++)
         {
+            int square = squareIndex(row, col);
+            int owner = squareOwner(state, square);
+            int posX = squarePosX(col);
+            int posY = squarePosY(row);
+            Color color = owner >= 0 ? pieces[owner].color : BEIGE;
+
             // draw the square and add a border
-            DrawRectangle(board[row][col].posX, board[row][col].posY,
-                          SQUARE_SIZE, SQUARE_SIZE, board[row][col].color);
-            DrawRectangleLinesEx(Rectangle{(float)board[row][col].posX,
-                                           (float)board[row][col].posY,
+            DrawRectangle(posX, posY, SQUARE_SIZE, SQUARE_SIZE, color);
+            DrawRectangleLinesEx(Rectangle{(float)posX, (float)posY,
                                            (float)SQUARE_SIZE, (float)SQUARE_SIZE},
                                  BORDER_WIDTH, BLACK);
 
             // add value text to the squares
-            drawSquareText(board[row][col].value, row, col, 30,
-                           board[row][col].posX, board[row][col].posY, 20);
+            drawSquareText(tileValue(state, square), row, col, 30, posX, posY, 20);
 
             // add weight text to the squares
-            drawSquareText(board[row][col].weight, row, col, 20,
-                           board[row][col].posX, board[row][col].posY, -10);
+            drawSquareText(tileWeight(state, square), row, col, 20, posX, posY, -10);
         }
     }
 }
@@ -570,10 +269,10 @@ void drawGameTable()
         (float)((TABLE_HEIGHT) + 2 * (FRAME_THICKNESS + 1))};
     DrawRectangleLinesEx(frameRect, (FRAME_THICKNESS + 1), BLACK);
 
-    drawPlayerInformation("Player 1 (Red)", p1Positions, pieces[0]);
-    drawPlayerInformation("Player 2 (Green)", p2Positions, pieces[1]);
-    drawPlayerInformation("Player 3 (Blue)", p3Positions, pieces[2]);
-    drawPlayerInformation("Player 4 (Yellow)", p4Positions, pieces[3]);
+    drawPlayerInformation("Player 1 (Red)", p1Positions, 0);
+    drawPlayerInformation("Player 2 (Green)", p2Positions, 1);
+    drawPlayerInformation("Player 3 (Blue)", p3Positions, 2);
+    drawPlayerInformation("Player 4 (Yellow)", p4Positions, 3);
 }
 
 void addOutline(Vector2 position, GamePiece &piece)
@@ -584,22 +283,18 @@ void addOutline(Vector2 position, GamePiece &piece)
     DrawCircleLinesV(position, piece.radius + 1, BLACK);
 }
 
-void drawPiece(GamePiece &piece, std::vector<std::vector<BoardSquare>> &board)
+void drawPiece(GamePiece &piece, const PieceState &state)
 {
-    BoardSquare &sq = board[piece.row][piece.col];
-    Vector2 pos = {
-        sq.posX + sq.width / 2.0f,
-        sq.posY + sq.height / 2.0f};
-    addOutline(pos, piece);
+    addOutline(piece.getPosition(state), piece);
 }
 
 void drawDraggingPiece()
 {
-    for (auto &piece : pieces)
+    for (int i = 0; i < (int)pieces.size(); i++)
     {
-        if (!dragging || selectedPiece != &piece)
+        if (!dragging || selectedPiece != &pieces[i])
         {
-            drawPiece(piece, board);
+            drawPiece(pieces[i], game.pieces[i]);
         }
     }
 
@@ -610,8 +305,10 @@ void drawDraggingPiece()
     }
 }
 
-void drawPlayerInformation(std::string player, PlayerTablePositions &playerPositions, GamePiece &piece)
+void drawPlayerInformation(std::string player, PlayerTablePositions &playerPositions, int playerIndex)
 {
+    const PieceState &piece = game.pieces[playerIndex];
+
     float underlineThickness = 2.0f;
     float underlineOffset = 3.0f;
     int playerFontSize = 25;
@@ -633,24 +330,24 @@ void drawPlayerInformation(std::string player, PlayerTablePositions &playerPosit
 
     Vector2 playerWeightTextPosition = {(float)((SCREEN_WIDTH / 2) + playerPositions.playerWeightOffsetX),
                                         (float)(startY + playerPositions.playerWeightOffsetY)};
-    DrawText(TextFormat("Weight: %d/24", piece.currentWeight), playerWeightTextPosition.x,
+    DrawText(TextFormat("Weight: %d/%d", piece.currentWeight, MAX_WEIGHT), playerWeightTextPosition.x,
              playerWeightTextPosition.y, playerValueFontSize, BLACK);
 
     Vector2 playerCurrentSquareText = {(float)((SCREEN_WIDTH / 2) + playerPositions.playerCurrentSquareOffsetX),
                                        (float)(startY + playerPositions.playerCurrentSquareOffsetY)};
-    DrawText(TextFormat("Current Square: %d/%d", board[piece.row][piece.col].value, board[piece.row][piece.col].weight),
+    DrawText(TextFormat("Current Square: %d/%d", tileValue(game, piece.square), tileWeight(game, piece.square)),
              playerCurrentSquareText.x, playerCurrentSquareText.y, playerValueFontSize, BLACK);
 
     std::string turnMarker;
 
-    if (piece.isCurrentPlayer)
+    if (!game.isGameOver && game.piecesIndex == playerIndex)
     {
         turnMarker = "*";
         DrawText(turnMarker.c_str(), playerTextPosition.x + 225, playerTextPosition.y, playerFontSize, BLACK);
     }
-    else if (isGameOver && piece.isWinner)
+    else if (game.isGameOver && isWinner(game, playerIndex))
     {
-        turnMarker = isTie ? "TIE" : "WINS";
+        turnMarker = game.isTie ? "TIE" : "WINS";
         DrawText(turnMarker.c_str(), playerTextPosition.x + 225, playerTextPosition.y, playerFontSize, BLACK);
         drawNewGameButton();
     }
@@ -0,0 +1,237 @@
+#include "arena.h"
+#include "bitboard.h"
+#include "ratings.h"
+#include "sprt.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+static void printUsage()
+{
+    std::printf("usage: tile-treasure-arena [-n boards] [-t threads] [-s seed] [--fixed-seats] [--results file]\n"
+                "                           [--balanced tolerance]\n"
+                "                           [--sprt delta [--score] [--alpha a] [--beta b]] bot [bot bot bot]\n"
+                "  bots: greedy, paranoid[:seconds], maxn[:seconds], mcts[:seconds], mcts-random[:seconds],\n"
+                "        paranoid-net:file[:seconds], maxn-net:file[:seconds], mcts-net:file[:seconds]\n"
+                "  one bot plays every seat, otherwise give one per seat in turn order.\n"
+                "  Every board is played in each distinct seat order unless --fixed-seats is given.\n"
+                "  --sprt tests whether the first seat's bot beats the other bot by delta, in win share\n"
+                "  per game or with --score in points, and stops once the test is decided.\n"
+                "  --results appends every game to file for tile-treasure-ratings.\n"
+                "  --balanced only plays boards whose seats' estimated points lie within tolerance.\n");
+}
+
+// one board's evidence for the SPRT: the candidate's mean outcome per seat game
+// minus the other bot's, so board luck shared by both cancels out
+static double boardSample(const std::vector<ArenaGame> &games, int candidate, bool byScore)
+{
+    double sums[2] = {0.0, 0.0};
+    int counts[2] = {0, 0};
+
+    for (const ArenaGame &game : games)
+    {
+        int winners = popCount(game.winnerMask);
+
+        for (int seat = 0; seat < NUM_PLAYERS; seat++)
+        {
+            int side = game.seatBots[seat] == candidate ? 0 : 1;
+            double share = (game.winnerMask & (1 << seat)) ? 1.0 / winners : 0.0;
+
+            sums[side] += byScore ? game.scores[seat] : share;
+            counts[side]++;
+        }
+    }
+
+    return sums[0] / counts[0] - sums[1] / counts[1];
+}
+
+static const char *sprtVerdict(SprtStatus status)
+{
+    switch (status)
+    {
+    case SprtStatus::AcceptH1:
+        return "H1 accepted, the first bot is better";
+    case SprtStatus::AcceptH0:
+        return "H0 accepted, the first bot is not better";
+    default:
+        return "undecided";
+    }
+}
+
+// plays bots against each other without a window and prints per-bot and per-seat results
+int main(int argc, char **argv)
+{
+    ArenaConfig config;
+    SprtConfig sprtConfig;
+    std::vector<std::string> specs;
+    std::vector<std::string> botNames;
+    std::string resultsPath;
+    bool useSprt = false;
+    bool byScore = false;
+
+    config.threads = (int)std::thread::hardware_concurrency();
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            config.boards = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            config.threads = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--fixed-seats") == 0)
+            config.rotateSeats = false;
+        else if (std::strcmp(argv[i], "--balanced") == 0 && i + 1 < argc)
+        {
+            config.balancedBoards = true;
+            config.balance.tolerance = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--results") == 0 && i + 1 < argc)
+            resultsPath = argv[++i];
+        else if (std::strcmp(argv[i], "--sprt") == 0 && i + 1 < argc)
+        {
+            useSprt = true;
+            sprtConfig.mu1 = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--score") == 0)
+            byScore = true;
+        else if (std::strcmp(argv[i], "--alpha") == 0 && i + 1 < argc)
+            sprtConfig.alpha = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--beta") == 0 && i + 1 < argc)
+            sprtConfig.beta = std::atof(argv[++i]);
+        else
+            specs.push_back(argv[i]);
+    }
+
+    if ((specs.size() != 1 && specs.size() != NUM_PLAYERS) || config.boards < 1)
+    {
+        printUsage();
+        return 1;
+    }
+
+    // seats with the same spec share one bot, so its results are pooled
+    for (int seat = 0; seat < NUM_PLAYERS; seat++)
+    {
+        const std::string &spec = specs[specs.size() == 1 ? 0 : seat];
+        size_t index = 0;
+
+        while (index < botNames.size() && botNames[index] != spec)
+            index++;
+
+        if (index == botNames.size())
+        {
+            BotConfig bot;
+
+            if (!parseBotSpec(spec, bot))
+            {
+                std::fprintf(stderr, "unknown bot: %s\n", spec.c_str());
+                printUsage();
+                return 1;
+            }
+
+            botNames.push_back(spec);
+            config.bots.push_back(bot);
+        }
+
+        config.lineup[seat] = (int)index;
+    }
+
+    if (useSprt && (config.bots.size() != 2 || sprtConfig.mu1 <= 0.0))
+    {
+        std::fprintf(stderr, "--sprt needs exactly two different bots and a positive delta\n");
+        return 1;
+    }
+
+    // the bounds are logs of alpha, beta and their complements
+    if (!(sprtConfig.alpha > 0.0 && sprtConfig.alpha < 1.0 && sprtConfig.beta > 0.0 && sprtConfig.beta < 1.0))
+    {
+        std::fprintf(stderr, "--alpha and --beta must lie strictly between 0 and 1\n");
+        printUsage();
+        return 1;
+    }
+
+    Sprt sprt(sprtConfig);
+
+    // progress goes to stderr on one line, redrawn as boards finish
+    if (useSprt)
+    {
+        int candidate = config.lineup[0];
+
+        config.onBoardFinished = [&](const std::vector<ArenaGame> &boardGames)
+        {
+            sprt.addSample(boardSample(boardGames, candidate, byScore));
+            std::fprintf(stderr, "\rboards %6lld  difference %+8.4f  llr %6.2f  bounds [%.2f, %.2f]",
+                         (long long)sprt.sampleCount(), sprt.mean(), sprt.llr(), sprt.lowerBound(), sprt.upperBound());
+            return sprt.status() == SprtStatus::Continue;
+        };
+    }
+
+    ArenaResult result = runArena(config);
+
+    if (result.unbalancedBoards > 0)
+    {
+        std::fprintf(stderr, "warning: %d of %d boards found no balanced deal in %d candidates and were kept as dealt\n",
+                     result.unbalancedBoards, config.boards, config.balance.maxCandidates);
+    }
+
+    if (useSprt)
+    {
+        std::fprintf(stderr, "\n\nSPRT: %s\n", sprtVerdict(sprt.status()));
+
+        if (sprt.sampleCount() > 1 && !sprt.hasVariance())
+            std::fprintf(stderr, "every board gave the same difference, %+.4f, so the test had no variance to work with\n",
+                         sprt.mean());
+
+        std::fprintf(stderr, "\n");
+    }
+
+    if (!resultsPath.empty())
+    {
+        std::vector<RatedGame> rated;
+
+        for (const ArenaGame &game : result.results)
+        {
+            RatedGame entry;
+
+            for (int seat = 0; seat < NUM_PLAYERS; seat++)
+                entry.players[seat] = game.seatBots[seat];
+
+            entry.scores = game.scores;
+            entry.weights = game.weights;
+            rated.push_back(entry);
+        }
+
+        if (!appendRatedGames(resultsPath, botNames, rated))
+            std::fprintf(stderr, "cannot write %s\n", resultsPath.c_str());
+    }
+
+    // every rate below is per game
+    if (result.games == 0)
+    {
+        std::printf("no games finished\n");
+        return 1;
+    }
+
+    std::printf("%-20s %10s %18s %12s\n", "bot", "seat games", "win rate", "mean score");
+
+    for (size_t b = 0; b < config.bots.size(); b++)
+    {
+        const ArenaBotResult &bot = result.bots[b];
+        std::printf("%-20s %10lld %10.3f +- %.3f %12.2f\n", botNames[b].c_str(), (long long)bot.seatGames,
+                    bot.winRate, bot.winRateError, (double)bot.scoreSum / bot.seatGames);
+    }
+
+    std::printf("\nwin rate by seat:");
+
+    for (int seat = 0; seat < NUM_PLAYERS; seat++)
+        std::printf(" %.3f", result.seatWinShares[seat] / result.games);
+
+    std::printf("\n%d games on %d boards, tie rate %.3f, %.1f s, %.1f games/sec on %d threads\n", result.games,
+                result.boards, (double)result.ties / result.games, result.elapsed, result.games / result.elapsed,
+                config.threads);
+    return 0;
+}
@@ -0,0 +1,294 @@
+#include "board_codec.h"
+#include "game_batch.h"
+#include "game_state.h"
+#include "greedy_bot.h"
+#include "mcts_bot.h"
+#include "move_gen.h"
+#include "network_eval.h"
+#include "path_solver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// greedy games per second one game at a time, then through the batch kernels
+static void benchGreedyBatch(int numGames)
+{
+    std::vector<GameState> games(numGames);
+
+    for (GameState &game : games)
+        initializeRandomGame(game);
+
+    std::vector<GameState> played = games;
+    auto start = std::chrono::steady_clock::now();
+
+    for (GameState &game : played)
+        playGreedyGame(game);
+
+    double single = numGames / secondsSince(start);
+
+    std::printf("\n%-16s %16s %10s\n", "greedy games", "games/sec", "speedup");
+    std::printf("%-16s %16.0f %9.2fx\n", "one at a time", single, 1.0);
+
+    const BatchKernel kernels[] = {BatchKernel::Scalar, BatchKernel::Avx2};
+    const char *names[] = {"batch scalar", "batch avx2"};
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (kernels[i] == BatchKernel::Avx2 && detectBatchKernel() != BatchKernel::Avx2)
+            continue;
+
+        GameBatch batch;
+        resizeBatch(batch, numGames);
+
+        for (int game = 0; game < numGames; game++)
+            loadBatchGame(batch, game, games[game]);
+
+        start = std::chrono::steady_clock::now();
+        playGreedyBatch(batch, kernels[i]);
+
+        double rate = numGames / secondsSince(start);
+        int mismatches = 0;
+
+        // the batch must play exactly the games playGreedyGame played
+        for (int game = 0; game < numGames; game++)
+        {
+            bool same = batchWinnerMask(batch, game) == played[game].winnerMask;
+
+            for (int player = 0; player < NUM_PLAYERS; player++)
+            {
+                same = same && batch.scores[player][game] == played[game].pieces[player].score &&
+                       batch.weights[player][game] == played[game].pieces[player].currentWeight;
+            }
+
+            mismatches += !same;
+        }
+
+        std::printf("%-16s %16.0f %9.2fx\n", names[i], rate, rate / single);
+
+        if (mismatches > 0)
+            std::printf("%d games ended differently from playGreedyGame\n", mismatches);
+    }
+}
+
+// boards per second dealt from a seed, packed to 40 bytes and unpacked into new games
+static void benchBoards(int numBoards)
+{
+    std::vector<GameState> boards(numBoards);
+    std::vector<PackedBoard> packed(numBoards);
+    uint64_t ids = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < numBoards; i++)
+        initializeSeededGame(boards[i], 1, (uint64_t)i);
+
+    double dealt = numBoards / secondsSince(start);
+    start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < numBoards; i++)
+    {
+        packed[i] = packBoard(boards[i]);
+        ids ^= boardId(packed[i]);
+    }
+
+    double packs = numBoards / secondsSince(start);
+    int mismatches = 0;
+    start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < numBoards; i++)
+    {
+        GameState board;
+        mismatches += !unpackBoard(packed[i], board) || board.tiles != boards[i].tiles;
+    }
+
+    double unpacks = numBoards / secondsSince(start);
+
+    std::printf("\n%-16s %16s\n", "boards", "boards/sec");
+    std::printf("%-16s %16.0f\n", "deal", dealt);
+    std::printf("%-16s %16.0f\n", "pack and id", packs);
+    std::printf("%-16s %16.0f\n", "unpack", unpacks);
+
+    if (mismatches > 0 || ids == 0)
+        std::printf("%d boards did not survive packing\n", mismatches);
+}
+
+// network evaluations per second one position at a time, then in batches of NET_MAX_BATCH
+static void benchNetwork(int numPositions)
+{
+    Network network;
+    initializeRandomNetwork(network, 1);
+
+    std::vector<GameState> positions(numPositions);
+    std::vector<const GameState *> pointers(numPositions);
+
+    for (int i = 0; i < numPositions; i++)
+    {
+        initializeSeededGame(positions[i], 2, (uint64_t)i);
+
+        for (int move = 0; move < i % 16; move++)
+            makeCPUMove(positions[i]);
+
+        pointers[i] = &positions[i];
+    }
+
+    std::vector<NetworkOutput> singles(numPositions);
+    std::vector<NetworkOutput> batched(numPositions);
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < numPositions; i++)
+        evaluateNetwork(network, positions[i], singles[i]);
+
+    double single = numPositions / secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    evaluateNetworkBatch(network, pointers.data(), numPositions, batched.data());
+
+    double batch = numPositions / secondsSince(start);
+    int mismatches = 0;
+
+    for (int i = 0; i < numPositions; i++)
+        mismatches += singles[i].winShares != batched[i].winShares;
+
+    std::printf("\n%-16s %16s %10s\n", "network", "evals/sec", "speedup");
+    std::printf("%-16s %16.0f %9.2fx\n", "one at a time", single, 1.0);
+    std::printf("%-16s %16.0f %9.2fx\n", "batched", batch, batch / single);
+
+    if (mismatches > 0)
+        std::printf("%d positions evaluated differently in a batch\n", mismatches);
+}
+
+// every walk the piece can make from square, no pruning, keeping the solver's preference:
+// most points, then least weight. Returns the best (value, weight).
+static std::pair<int, int> enumerateRoutes(const GameState &state, int square, uint64_t open, int remaining)
+{
+    uint64_t moves = KING_MOVES[square] & open & state.weightMasks[std::min(remaining, MAX_TILE_WEIGHT)];
+    std::pair<int, int> best(INT_MIN, 0);
+
+    if (moves == 0)
+        return std::make_pair(0, 0);
+
+    while (moves)
+    {
+        int dest = popLowestSquare(moves);
+        std::pair<int, int> rest = enumerateRoutes(state, dest, open & ~squareBit(dest), remaining - tileWeight(state, dest));
+        int value = rest.first + tileValue(state, dest);
+        int weight = rest.second + tileWeight(state, dest);
+
+        if (value > best.first || (value == best.first && weight < best.second))
+            best = std::make_pair(value, weight);
+    }
+
+    return best;
+}
+
+// the route solver against exhaustive enumeration on midgame positions, where walks
+// are short enough to enumerate, and the bound against the solved value
+static void benchRoutes(int numPositions)
+{
+    int solved = 0;
+    int mismatches = 0;
+    int badBounds = 0;
+    double solverTime = 0.0;
+
+    for (int i = 0; i < numPositions; i++)
+    {
+        GameState position;
+        initializeSeededGame(position, 3, (uint64_t)i);
+
+        for (int move = 0; move < 8 + i % 16 && !position.isGameOver; move++)
+            makeCPUMove(position);
+
+        for (int player = 0; player < NUM_PLAYERS; player++)
+        {
+            if (!isActive(position, player))
+                continue;
+
+            auto start = std::chrono::steady_clock::now();
+            RouteResult route = solveBestRoute(position, player);
+            solverTime += secondsSince(start);
+
+            const PieceState &piece = position.pieces[player];
+            uint64_t open = ~position.visited & BOARD_MASK;
+            std::pair<int, int> exact = enumerateRoutes(position, piece.square, open, MAX_WEIGHT - piece.currentWeight);
+
+            solved++;
+            mismatches += route.value != exact.first || route.weight != exact.second;
+            badBounds += routeUpperBound(position, player) < exact.first;
+        }
+    }
+
+    std::printf("\n%-16s %16s %10s\n", "routes", "solves/sec", "checked");
+    std::printf("%-16s %16.0f %10d\n", "midgame", solved / solverTime, solved);
+
+    if (mismatches > 0 || badBounds > 0)
+        std::printf("%d routes differ from enumeration, %d bounds below the best route\n", mismatches, badBounds);
+}
+
+// measures tree-parallel MCTS throughput for 1, 2, 4, ... threads on the same positions
+int main(int argc, char **argv)
+{
+    int maxThreads = argc > 1 ? std::atoi(argv[1]) : (int)std::thread::hardware_concurrency();
+    double timeBudget = argc > 2 ? std::atof(argv[2]) : 0.5;
+    const int numPositions = 8;
+
+    if (maxThreads < 1)
+        maxThreads = 1;
+
+    // opening positions a few greedy moves in, so every search has real choices
+    std::vector<GameState> positions(numPositions);
+
+    for (GameState &position : positions)
+    {
+        initializeRandomGame(position);
+
+        for (int i = 0; i < 4; i++)
+            makeCPUMove(position);
+    }
+
+    std::printf("%8s %16s %18s %10s\n", "threads", "playouts/sec", "per thread", "speedup");
+
+    double baseline = 0.0;
+
+    for (int threads = 1; threads <= maxThreads; threads = std::min(threads * 2, maxThreads))
+    {
+        MctsConfig config;
+        config.timeBudget = timeBudget;
+        config.threads = threads;
+        config.virtualLoss = threads > 1 ? 3 : 1;
+        config.maxNodes = 1 << 22;
+
+        int64_t playouts = 0;
+        double elapsed = 0.0;
+
+        for (const GameState &position : positions)
+        {
+            MctsResult result = searchMcts(position, config);
+            playouts += result.playouts;
+            elapsed += result.elapsed;
+        }
+
+        double rate = playouts / elapsed;
+
+        if (threads == 1)
+            baseline = rate;
+
+        std::printf("%8d %16.0f %18.0f %9.2fx\n", threads, rate, rate / threads, rate / baseline);
+
+        if (threads == maxThreads)
+            break;
+    }
+
+    benchGreedyBatch(1 << 16);
+    benchBoards(1 << 20);
+    benchNetwork(1 << 16);
+    benchRoutes(200);
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "ratings.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+static void printUsage()
+{
+    std::printf("usage: tile-treasure-ratings [-t threads] results [results ...]\n"
+                "  results are files written by tile-treasure-arena --results, one game per line.\n"
+                "  Prints Plackett-Luce ratings in Elo, centred on the mean bot, with 95%% intervals.\n");
+}
+
+// fits ratings to every game in the given results files
+int main(int argc, char **argv)
+{
+    int threads = (int)std::thread::hardware_concurrency();
+    std::vector<std::string> paths;
+    std::vector<std::string> names;
+    std::vector<RatedGame> games;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            threads = std::atoi(argv[++i]);
+        else
+            paths.push_back(argv[i]);
+    }
+
+    if (paths.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    for (const std::string &path : paths)
+    {
+        if (!loadRatedGames(path, names, games))
+        {
+            std::fprintf(stderr, "cannot read %s\n", path.c_str());
+            return 1;
+        }
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    RatingResult result = fitRatings(games, (int)names.size(), threads);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    std::vector<int> order(names.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return result.elo[a] > result.elo[b]; });
+
+    std::printf("%-24s %10s %18s\n", "bot", "seat games", "elo, 95% interval");
+
+    for (int player : order)
+    {
+        std::printf("%-24s %10lld %8.1f +- %6.1f\n", names[player].c_str(), (long long)result.games[player],
+                    result.elo[player], 1.96 * result.eloError[player]);
+    }
+
+    std::printf("\n%zu games, %d iterations%s, %.2f s on %d threads\n", games.size(), result.iterations,
+                result.converged ? "" : " (not converged)", elapsed, threads);
+    return 0;
+}
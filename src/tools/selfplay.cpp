@@ -0,0 +1,69 @@
+#include "counter_rng.h"
+#include "game_state.h"
+#include "selfplay_export.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// plays MCTS self-play games on every thread and appends their positions to a columnar file
+int main(int argc, char **argv)
+{
+    int numGames = argc > 1 ? std::atoi(argv[1]) : 100;
+    int numThreads = argc > 2 ? std::atoi(argv[2]) : (int)std::thread::hardware_concurrency();
+    const char *path = argc > 3 ? argv[3] : "selfplay.ttsp";
+    int playouts = argc > 4 ? std::atoi(argv[4]) : 800;
+    uint64_t seed = argc > 5 ? std::strtoull(argv[5], nullptr, 10) : randomSeed();
+
+    if (numThreads < 1)
+        numThreads = 1;
+
+    SelfPlayWriter writer(path);
+
+    if (!writer.isOpen())
+    {
+        std::fprintf(stderr, "cannot open %s\n", path);
+        return 1;
+    }
+
+    SelfPlayConfig config;
+    config.mcts.seed = seed;
+    config.mcts.maxPlayouts = playouts;
+    config.mcts.timeBudget = 1e9; // playouts bound every search, not time
+    config.mcts.rolloutPolicy = RolloutPolicy::Greedy;
+    config.mcts.maxNodes = (size_t)playouts * 8 + 8; // one expansion per playout at most
+
+    std::atomic<int> nextGame(0);
+    std::vector<std::thread> threads;
+    auto startTime = std::chrono::steady_clock::now();
+
+    // each thread takes the next game number until none are left
+    for (int thread = 0; thread < numThreads; thread++)
+    {
+        threads.emplace_back([&]()
+                             {
+                                 SelfPlayBuffer buffer(writer);
+                                 int game;
+
+                                 while ((game = nextGame.fetch_add(1)) < numGames)
+                                 {
+                                     GameState state;
+                                     initializeSeededGame(state, seed, (uint64_t)game);
+                                     playSelfPlayGame(state, (uint64_t)game, config, buffer);
+                                 }
+                             });
+    }
+
+    for (std::thread &thread : threads)
+        thread.join();
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    // the seed and game number regenerate any game, boards and moves alike
+    std::printf("%d games, %lld positions in %.1f s (%.1f games/sec) -> %s, seed %llu\n", numGames,
+                (long long)writer.rowsWritten(), elapsed, numGames / elapsed, path, (unsigned long long)seed);
+    return 0;
+}